@@ -17,7 +17,7 @@ AsteroidNode asteroidInit(void) {
 }
 
 void asteroidSpawn(AsteroidNode *asteroids, Asteroid *refAsteroid,
-                   Sprite *spriteList) {
+                   SpriteRegistry *sprites) {
   Asteroid asteroid; /* SDL_rand(Number Of Outcomes) + lowerValue -> lowerValue
                         to NumberOfOutcome - 1*/
 
@@ -55,7 +55,9 @@ void asteroidSpawn(AsteroidNode *asteroids, Asteroid *refAsteroid,
     asteroid.rotVel = SDL_rand(10) - 5;
   }
 
-  asteroid.spriteRect = getSpriteRect(spriteList, spriteName);
+  asteroid.sprite = spriteFind(sprites, spriteName);
+  asteroid.spriteRect = spriteRect(sprites, asteroid.sprite);
+  free(spriteName);
 
   switch (SDL_rand(4)) {
   case 0: /* Up */
@@ -137,13 +139,13 @@ void asteroidSpawn(AsteroidNode *asteroids, Asteroid *refAsteroid,
 }
 
 void asteroidDestroy(Asteroid *asteroid, AsteroidNode *asteroids,
-                     Sprite *spriteList, Mix_Chunk *astDestroySfx) {
+                     SpriteRegistry *sprites, Mix_Chunk *astDestroySfx) {
   Mix_PlayChannel(1, astDestroySfx, 0);
   if (asteroid->size != SMALL) /* Spawn Asteroids Of Larger Asteroid */
   {
     uint8 num = SDL_rand(4) + 3; /* Number Of Asteroids to Spawn */
     for (uint8 astNum = 0; astNum < num; astNum++) {
-      asteroidSpawn(asteroids, asteroid, spriteList);
+      asteroidSpawn(asteroids, asteroid, sprites);
     }
   }
 
@@ -163,7 +165,7 @@ void asteroidDestroy(Asteroid *asteroid, AsteroidNode *asteroids,
 
 void asteroidHandler(AsteroidNode *asteroids, PowerUpNode *powerUps,
                      Player *player, Timer *spawnTimer, int *spawnCount,
-                     int spawnTime, double delta, Sprite *spriteList,
+                     int spawnTime, double delta, SpriteRegistry *sprites,
                      Mix_Chunk *astDestroySfx) {
   /* Asteroids - Bullet Collision Detector & Destroyer */
   AsteroidNode *astPtr = asteroids->nextAsteroid;
@@ -178,7 +180,7 @@ void asteroidHandler(AsteroidNode *asteroids, PowerUpNode *powerUps,
           powerUpSpawn(&astPtr->asteroid, powerUps);
         }
 
-        asteroidDestroy(&astPtr->asteroid, asteroids, spriteList,
+        asteroidDestroy(&astPtr->asteroid, asteroids, sprites,
                         astDestroySfx); /* Destroy Objects */
         bulletDestroy(&bullPtr->bullet, &player->bullets);
         destroyed = true;
@@ -190,7 +192,7 @@ void asteroidHandler(AsteroidNode *asteroids, PowerUpNode *powerUps,
 
     if (!destroyed) {
       if (SDL_HasRectIntersectionFloat(&astPtr->asteroid.rect, &player->rect)) {
-        asteroidDestroy(&astPtr->asteroid, asteroids, spriteList,
+        asteroidDestroy(&astPtr->asteroid, asteroids, sprites,
                         astDestroySfx);
         if (!player->shieldTimer.started) {
           player->armor--;
@@ -204,7 +206,7 @@ void asteroidHandler(AsteroidNode *asteroids, PowerUpNode *powerUps,
 
   /* Asteroid Spawner */
   if (spawnTimer->ticks > SDL_rand(3000) + spawnTime) {
-    asteroidSpawn(asteroids, NULL, spriteList);
+    asteroidSpawn(asteroids, NULL, sprites);
     (*spawnCount)++;
     timerReset(spawnTimer); /* Reset Timer */
   }
@@ -3,7 +3,7 @@
 
 #include "includes.h"
 
-typedef struct Sprite Sprite;
+typedef struct SpriteRegistry SpriteRegistry;
 typedef struct PowerUpNode PowerUpNode;
 typedef struct Player Player;
 typedef struct Timer Timer;
@@ -28,6 +28,7 @@ typedef struct Asteroid {
   uint32 astNum;
 
   SDL_FRect rect;
+  int sprite; /* Sprite ID */
   SDL_FRect spriteRect;
 } Asteroid;
 
@@ -37,10 +38,10 @@ typedef struct AsteroidNode {
 } AsteroidNode;
 
 AsteroidNode asteroidInit(void);
-void asteroidSpawn(AsteroidNode *asteroids, Asteroid *refAsteroid, Sprite *spriteList); 
-void asteroidDestroy(Asteroid *asteroid, AsteroidNode *asteroids, Sprite *spriteList, Mix_Chunk *astDestroySfx); 
+void asteroidSpawn(AsteroidNode *asteroids, Asteroid *refAsteroid, SpriteRegistry *sprites); 
+void asteroidDestroy(Asteroid *asteroid, AsteroidNode *asteroids, SpriteRegistry *sprites, Mix_Chunk *astDestroySfx); 
 void asteroidHandler(AsteroidNode *asteroids, PowerUpNode *powerUps,
                      Player *player, Timer *spawnTimer, int *spawnCount,
-                     int spawnTime, double delta, Sprite *spriteList, Mix_Chunk *astDestroySfx); 
+                     int spawnTime, double delta, SpriteRegistry *sprites, Mix_Chunk *astDestroySfx); 
 
 #endif //ASTEROID_H_
@@ -58,6 +58,37 @@
 
 #include "cJSON.h"
 
+/* SSE2 is always there on x86-64, AVX2 is checked for at runtime */
+#if !defined(CJSON_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)))
+#define CJSON_SIMD_X86
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define CJSON_SIMD_AVX2
+#endif
+
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+#if defined(_MSC_VER)
+#pragma warning (push)
+#pragma warning (disable : 4001)
+#endif
+
+#include <emmintrin.h>
+#ifdef CJSON_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#endif
+#endif
+
 /* define our own boolean type */
 #ifdef true
 #undef true
@@ -158,6 +189,7 @@ typedef struct internal_hooks
     void *(CJSON_CDECL *allocate)(size_t size);
     void (CJSON_CDECL *deallocate)(void *pointer);
     void *(CJSON_CDECL *reallocate)(void *pointer, size_t size);
+    cJSON_Arena *arena; /* allocate from it instead when set, freeing is a no-op */
 } internal_hooks;
 
 #if defined(_MSC_VER)
@@ -183,7 +215,166 @@ static void * CJSON_CDECL internal_realloc(void *pointer, size_t size)
 /* strlen of character literals resolved at compile time */
 #define static_strlen(string_literal) (sizeof(string_literal) - sizeof(""))
 
-static internal_hooks global_hooks = { internal_malloc, internal_free, internal_realloc };
+static internal_hooks global_hooks = { internal_malloc, internal_free, internal_realloc, NULL };
+
+/* Arena chunks are filled front to back and only freed as a whole */
+typedef struct arena_chunk
+{
+    struct arena_chunk *next;
+    size_t size; /* usable bytes after the header */
+    size_t used;
+    size_t last; /* offset of the most recent allocation, which can grow in place */
+} arena_chunk;
+
+struct cJSON_Arena
+{
+    internal_hooks hooks; /* what the arena's documents allocate through, hooks.arena points back here */
+    internal_hooks chunk_hooks; /* where the chunks come from */
+    arena_chunk *chunks; /* the one being filled first */
+    size_t chunk_size;
+};
+
+#define arena_align(size) (((size) + (sizeof(double) - 1)) & ~(sizeof(double) - 1))
+#define arena_header_size arena_align(sizeof(arena_chunk))
+#define arena_data(chunk) ((unsigned char*)(chunk) + arena_header_size)
+
+static arena_chunk *arena_add_chunk(cJSON_Arena * const arena, size_t size)
+{
+    arena_chunk *chunk = NULL;
+
+    if (size > (((size_t)-1) - arena_header_size))
+    {
+        return NULL;
+    }
+    chunk = (arena_chunk*)arena->chunk_hooks.allocate(arena_header_size + size);
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->last = 0;
+
+    if ((arena->chunks == NULL) || (size == arena->chunk_size))
+    {
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+    else
+    {
+        /* a chunk for one big allocation, keep filling the current one */
+        chunk->next = arena->chunks->next;
+        arena->chunks->next = chunk;
+    }
+
+    return chunk;
+}
+
+static void *arena_allocate(cJSON_Arena * const arena, size_t size)
+{
+    arena_chunk *chunk = arena->chunks;
+
+    if (size > (((size_t)-1) - sizeof(double)))
+    {
+        return NULL;
+    }
+    size = arena_align(size);
+
+    if ((chunk == NULL) || (size > (chunk->size - chunk->used)))
+    {
+        chunk = arena_add_chunk(arena, (size > (arena->chunk_size / 4)) ? size : arena->chunk_size);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+    }
+    chunk->last = chunk->used;
+    chunk->used += size;
+
+    return arena_data(chunk) + chunk->last;
+}
+
+static void *arena_reallocate(cJSON_Arena * const arena, void *pointer, size_t old_size, size_t new_size)
+{
+    arena_chunk *chunk = arena->chunks;
+    unsigned char *new_pointer = NULL;
+
+    /* the most recent allocation grows in place while its chunk has room */
+    if ((chunk != NULL) && (pointer == arena_data(chunk) + chunk->last) && (new_size <= (chunk->size - chunk->last)))
+    {
+        chunk->used = chunk->last + arena_align(new_size);
+        return pointer;
+    }
+
+    new_pointer = (unsigned char*)arena_allocate(arena, new_size);
+    if ((new_pointer != NULL) && (pointer != NULL))
+    {
+        memcpy(new_pointer, pointer, old_size);
+    }
+
+    return new_pointer;
+}
+
+static void *hooks_allocate(const internal_hooks * const hooks, size_t size)
+{
+    if (hooks->arena != NULL)
+    {
+        return arena_allocate(hooks->arena, size);
+    }
+
+    return hooks->allocate(size);
+}
+
+static void hooks_deallocate(const internal_hooks * const hooks, void *pointer)
+{
+    if (hooks->arena == NULL)
+    {
+        hooks->deallocate(pointer);
+    }
+}
+
+/* An object's key index, open addressing on the key hashes with NULL for empty slots,
+ * or an array's items in list order */
+struct cJSON_Index
+{
+    cJSON **items;
+    size_t count;
+    size_t size; /* objects: a power of 2, at least twice count. arrays: the capacity */
+};
+
+static unsigned int key_hash(const unsigned char *key)
+{
+    /* FNV-1a over the lowercased key, so lookups of either case sensitivity can use it */
+    unsigned int hash = 2166136261u;
+
+    for (; *key != '\0'; key++)
+    {
+        hash = (hash ^ (unsigned int)tolower(*key)) * 16777619u;
+    }
+
+    return hash;
+}
+
+static unsigned int item_key_hash(cJSON * const item)
+{
+    if (!(item->flags & cJSON_KeyHashed))
+    {
+        item->hash = key_hash((const unsigned char*)item->string);
+        item->flags |= cJSON_KeyHashed;
+    }
+
+    return item->hash;
+}
+
+static void index_free(cJSON * const item)
+{
+    if (item->index != NULL)
+    {
+        global_hooks.deallocate(item->index->items);
+        global_hooks.deallocate(item->index);
+        item->index = NULL;
+    }
+}
 
 static unsigned char* cJSON_strdup(const unsigned char* string, const internal_hooks * const hooks)
 {
@@ -196,7 +387,7 @@ static unsigned char* cJSON_strdup(const unsigned char* string, const internal_h
     }
 
     length = strlen((const char*)string) + sizeof("");
-    copy = (unsigned char*)hooks->allocate(length);
+    copy = (unsigned char*)hooks_allocate(hooks, length);
     if (copy == NULL)
     {
         return NULL;
@@ -240,10 +431,15 @@ CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
 {
-    cJSON* node = (cJSON*)hooks->allocate(sizeof(cJSON));
+    cJSON* node = (cJSON*)hooks_allocate(hooks, sizeof(cJSON));
     if (node)
     {
         memset(node, '\0', sizeof(cJSON));
+        if (hooks->arena != NULL)
+        {
+            /* strings cJSON stores on the item come from the same place */
+            node->flags = cJSON_ArenaItem | cJSON_ArenaValuestring | cJSON_ArenaString;
+        }
     }
 
     return node;
@@ -262,15 +458,25 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
         }
         if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
         {
-            global_hooks.deallocate(item->valuestring);
+            if (!(item->flags & (cJSON_ArenaValuestring | cJSON_InsituValuestring)))
+            {
+                global_hooks.deallocate(item->valuestring);
+            }
             item->valuestring = NULL;
         }
         if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
         {
-            global_hooks.deallocate(item->string);
+            if (!(item->flags & (cJSON_ArenaString | cJSON_InsituString)))
+            {
+                global_hooks.deallocate(item->string);
+            }
             item->string = NULL;
         }
-        global_hooks.deallocate(item);
+        index_free(item);
+        if (!(item->flags & cJSON_ArenaItem))
+        {
+            global_hooks.deallocate(item);
+        }
         item = next;
     }
 }
@@ -293,6 +499,7 @@ typedef struct
     size_t offset;
     size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
     internal_hooks hooks;
+    cJSON_bool insitu; /* content is the caller's mutable buffer, unescape strings into it */
 } parse_buffer;
 
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
@@ -303,6 +510,115 @@ typedef struct
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
+/* Doubles only round once per operation where intermediate results aren't kept wider (not x87) */
+#if (defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)) || (defined(__FLT_EVAL_METHOD__) && (__FLT_EVAL_METHOD__ == 0)) || defined(_M_X64)
+#define CJSON_EXACT_DOUBLE_MATH
+
+/* Powers of ten that are exact in a double */
+static const double exact_powers_of_ten[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#endif
+
+/* Parses the numbers that need no strtod: up to 15 significant digits are exact in a double, and
+ * scaling them by an exact power of ten is a single correctly rounded operation, so the result is
+ * what strtod gives. Needs no locale. Returns false for anything else, including the forms strtod
+ * is more lenient about, so the caller falls back to strtod for them. */
+static cJSON_bool parse_number_fast(const unsigned char * const input, size_t length, double * const number, size_t * const consumed)
+{
+    double mantissa = 0;
+    cJSON_bool negative = false;
+    int digits = 0;
+    int exponent = 0;
+    int exponent_part = 0;
+    cJSON_bool exponent_negative = false;
+    size_t i = 0;
+
+    if ((i < length) && (input[i] == '-'))
+    {
+        negative = true;
+        i++;
+    }
+    if ((i >= length) || (input[i] < '0') || (input[i] > '9'))
+    {
+        return false;
+    }
+
+    for (; (i < length) && (input[i] >= '0') && (input[i] <= '9'); i++)
+    {
+        mantissa = (mantissa * 10) + (input[i] - '0');
+        digits += (mantissa != 0) ? 1 : 0;
+    }
+
+    if ((i < length) && (input[i] == '.'))
+    {
+        i++;
+        if ((i >= length) || (input[i] < '0') || (input[i] > '9'))
+        {
+            return false;
+        }
+        for (; (i < length) && (input[i] >= '0') && (input[i] <= '9'); i++)
+        {
+            mantissa = (mantissa * 10) + (input[i] - '0');
+            digits += (mantissa != 0) ? 1 : 0;
+            exponent--;
+        }
+    }
+
+    if ((i < length) && ((input[i] == 'e') || (input[i] == 'E')))
+    {
+        i++;
+        if ((i < length) && ((input[i] == '+') || (input[i] == '-')))
+        {
+            exponent_negative = (input[i] == '-');
+            i++;
+        }
+        if ((i >= length) || (input[i] < '0') || (input[i] > '9'))
+        {
+            return false;
+        }
+        for (; (i < length) && (input[i] >= '0') && (input[i] <= '9'); i++)
+        {
+            if (exponent_part > 1000)
+            {
+                return false;
+            }
+            exponent_part = (exponent_part * 10) + (input[i] - '0');
+        }
+        exponent += exponent_negative ? -exponent_part : exponent_part;
+    }
+
+    if (digits > 15)
+    {
+        return false;
+    }
+    if ((mantissa == 0) || (exponent == 0))
+    {
+        /* exact as it is */
+    }
+#ifdef CJSON_EXACT_DOUBLE_MATH
+    else if ((exponent > 0) && (exponent <= 22))
+    {
+        mantissa *= exact_powers_of_ten[exponent];
+    }
+    else if ((exponent < 0) && (exponent >= -22))
+    {
+        mantissa /= exact_powers_of_ten[-exponent];
+    }
+#endif
+    else
+    {
+        return false;
+    }
+
+    *number = negative ? -mantissa : mantissa;
+    *consumed = i;
+
+    return true;
+}
+
 /* Parse the input text to generate a number, and populate the result into item. */
 static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
 {
@@ -310,6 +626,7 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
     unsigned char *after_end = NULL;
     unsigned char number_c_string[64];
     unsigned char decimal_point = get_decimal_point();
+    size_t available = 0;
     size_t i = 0;
 
     if ((input_buffer == NULL) || (input_buffer->content == NULL))
@@ -317,6 +634,18 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
         return false;
     }
 
+    /* strtod would only see as much as fits the temporary buffer */
+    available = input_buffer->length - input_buffer->offset;
+    if (available > (sizeof(number_c_string) - 1))
+    {
+        available = sizeof(number_c_string) - 1;
+    }
+    if (parse_number_fast(buffer_at_offset(input_buffer), available, &number, &i))
+    {
+        after_end = number_c_string + i;
+        goto parsed;
+    }
+
     /* copy the number into a temporary buffer and replace '.' with the decimal point
      * of the current locale (for strtod)
      * This also takes care of '\0' not necessarily being available for marking the end of the input */
@@ -358,6 +687,7 @@ loop_end:
         return false; /* parse_error */
     }
 
+parsed:
     item->valuedouble = number;
 
     /* use saturation in case of overflow */
@@ -434,11 +764,12 @@ CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
     {
         return NULL;
     }
-    if (object->valuestring != NULL)
+    if ((object->valuestring != NULL) && !(object->flags & (cJSON_ArenaValuestring | cJSON_InsituValuestring)))
     {
         cJSON_free(object->valuestring);
     }
     object->valuestring = copy;
+    object->flags &= ~(cJSON_ArenaValuestring | cJSON_InsituValuestring);
 
     return copy;
 }
@@ -452,6 +783,8 @@ typedef struct
     cJSON_bool noalloc;
     cJSON_bool format; /* is this print a formatted print */
     internal_hooks hooks;
+    cJSON_PrintWriter write; /* when streaming, the buffer is written out instead of grown */
+    void *write_user;
 } printbuffer;
 
 /* realloc printbuffer if necessary to have at least "needed" bytes more */
@@ -483,6 +816,21 @@ static unsigned char* ensure(printbuffer * const p, size_t needed)
         return p->buffer + p->offset;
     }
 
+    /* everything before offset is complete, so it can go and the buffer start over */
+    if (p->write != NULL)
+    {
+        if ((p->offset > 0) && !p->write(p->write_user, (const char*)p->buffer, p->offset))
+        {
+            return NULL;
+        }
+        needed -= p->offset;
+        p->offset = 0;
+        if (needed <= p->length)
+        {
+            return p->buffer;
+        }
+    }
+
     if (p->noalloc) {
         return NULL;
     }
@@ -505,7 +853,18 @@ static unsigned char* ensure(printbuffer * const p, size_t needed)
         newsize = needed * 2;
     }
 
-    if (p->hooks.reallocate != NULL)
+    if (p->hooks.arena != NULL)
+    {
+        newbuffer = (unsigned char*)arena_reallocate(p->hooks.arena, p->buffer, p->length, newsize);
+        if (newbuffer == NULL)
+        {
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+    }
+    else if (p->hooks.reallocate != NULL)
     {
         /* reallocate with realloc if available */
         newbuffer = (unsigned char*)p->hooks.reallocate(p->buffer, newsize);
@@ -560,6 +919,49 @@ static cJSON_bool compare_double(double a, double b)
     return (fabs(a - b) <= maxVal * DBL_EPSILON);
 }
 
+/* Prints an integral double below 1e15, which "%1.15g" would also print without an exponent */
+static int print_integer(double d, unsigned char * const number_buffer)
+{
+    unsigned char digits[16];
+    unsigned long high = 0;
+    unsigned long low = 0;
+    int count = 0;
+    int length = 0;
+    int i = 0;
+
+    if (d < 0)
+    {
+        number_buffer[length++] = '-';
+        d = -d;
+    }
+
+    /* both halves fit an unsigned long even where that is 32 bits */
+    high = (unsigned long)(d / 1e9);
+    low = (unsigned long)(d - ((double)high * 1e9));
+    for (i = 0; i < 9; i++)
+    {
+        digits[count++] = (unsigned char)('0' + (low % 10));
+        low /= 10;
+        if ((high == 0) && (low == 0))
+        {
+            break;
+        }
+    }
+    while (high > 0)
+    {
+        digits[count++] = (unsigned char)('0' + (high % 10));
+        high /= 10;
+    }
+
+    while (count > 0)
+    {
+        number_buffer[length++] = digits[--count];
+    }
+    number_buffer[length] = '\0';
+
+    return length;
+}
+
 /* Render the number nicely from the given item into a string. */
 static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
 {
@@ -569,7 +971,7 @@ static cJSON_bool print_number(const cJSON * const item, printbuffer * const out
     size_t i = 0;
     unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
     unsigned char decimal_point = get_decimal_point();
-    double test = 0.0;
+    int precision = 0;
 
     if (output_buffer == NULL)
     {
@@ -581,19 +983,24 @@ static cJSON_bool print_number(const cJSON * const item, printbuffer * const out
     {
         length = sprintf((char*)number_buffer, "null");
     }
-    else if(d == (double)item->valueint)
+    else if ((d == floor(d)) && (fabs(d) < 1e15))
     {
-        length = sprintf((char*)number_buffer, "%d", item->valueint);
+        length = print_integer(d, number_buffer);
     }
     else
     {
-        /* Try 15 decimal places of precision to avoid nonsignificant nonzero digits */
-        length = sprintf((char*)number_buffer, "%1.15g", d);
-
-        /* Check whether the original double can be recovered */
-        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || !compare_double((double)test, d))
+        /* The fewest digits that read back as the same double: 15 are enough for most, 17 for any.
+         * Subnormals have fewer significant bits, so they can need fewer than 15 */
+        for (precision = (fabs(d) < DBL_MIN) ? 1 : 15; precision < 17; precision++)
+        {
+            length = sprintf((char*)number_buffer, "%1.*g", precision, d);
+            if (strtod((const char*)number_buffer, NULL) == d)
+            {
+                break;
+            }
+        }
+        if (precision == 17)
         {
-            /* If not, print with 17 decimal places of precision */
             length = sprintf((char*)number_buffer, "%1.17g", d);
         }
     }
@@ -788,60 +1195,446 @@ fail:
     return 0;
 }
 
-/* Parse the input text into an unescaped cinput, and populate item. */
-static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+/* Scanners: each returns how many bytes from start come before the first one it looks for,
+ * or length if none of them do. string stops at a quote or backslash, escape also at control
+ * characters and whitespace at anything that isn't whitespace (> 32). */
+typedef size_t (*scan_function)(const unsigned char *start, size_t length);
+
+typedef struct
 {
-    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
-    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
-    unsigned char *output_pointer = NULL;
-    unsigned char *output = NULL;
+    scan_function string;
+    scan_function escape;
+    scan_function whitespace;
+    int level;
+} scanners;
 
-    /* not a string */
-    if (buffer_at_offset(input_buffer)[0] != '\"')
+static size_t scan_string_scalar(const unsigned char *start, size_t length)
+{
+    size_t i = 0;
+
+    while ((i < length) && (start[i] != '\"') && (start[i] != '\\'))
     {
-        goto fail;
+        i++;
     }
 
-    {
-        /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
-        size_t skipped_bytes = 0;
-        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
-        {
-            /* is escape sequence */
-            if (input_end[0] == '\\')
-            {
-                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
-                {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
-            }
-            input_end++;
-        }
-        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
-        {
-            goto fail; /* string ended unexpectedly */
-        }
+    return i;
+}
 
-        /* This is at most how much we need for the output */
-        allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
-        if (output == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
+static size_t scan_escape_scalar(const unsigned char *start, size_t length)
+{
+    size_t i = 0;
+
+    while ((i < length) && (start[i] > 31) && (start[i] != '\"') && (start[i] != '\\'))
+    {
+        i++;
     }
 
-    output_pointer = output;
-    /* loop through the string literal */
-    while (input_pointer < input_end)
+    return i;
+}
+
+static size_t scan_whitespace_scalar(const unsigned char *start, size_t length)
+{
+    size_t i = 0;
+
+    while ((i < length) && (start[i] <= 32))
+    {
+        i++;
+    }
+
+    return i;
+}
+
+static const scanners scalar_scanners = { scan_string_scalar, scan_escape_scalar, scan_whitespace_scalar, cJSON_SimdNone };
+
+#ifdef CJSON_SIMD_X86
+/* index of the lowest set bit, mask is not 0 */
+static size_t first_set(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (size_t)index;
+#else
+    return (size_t)__builtin_ctz(mask);
+#endif
+}
+
+static size_t scan_string_sse2(const unsigned char *start, size_t length)
+{
+    __m128i quote;
+    __m128i backslash;
+    __m128i chunk;
+    unsigned int mask = 0;
+    size_t i = 0;
+
+    if (length < 16)
+    {
+        return scan_string_scalar(start, length);
+    }
+
+    quote = _mm_set1_epi8('\"');
+    backslash = _mm_set1_epi8('\\');
+    for (i = 0; i < length; i += 16)
+    {
+        /* the last block overlaps bytes already known not to match */
+        if ((i + 16) > length)
+        {
+            i = length - 16;
+        }
+        chunk = _mm_loadu_si128((const __m128i*)(const void*)(start + i));
+        mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+        if (mask != 0)
+        {
+            return i + first_set(mask);
+        }
+    }
+
+    return length;
+}
+
+static size_t scan_escape_sse2(const unsigned char *start, size_t length)
+{
+    __m128i quote;
+    __m128i backslash;
+    __m128i control;
+    __m128i chunk;
+    __m128i special;
+    unsigned int mask = 0;
+    size_t i = 0;
+
+    if (length < 16)
+    {
+        return scan_escape_scalar(start, length);
+    }
+
+    quote = _mm_set1_epi8('\"');
+    backslash = _mm_set1_epi8('\\');
+    control = _mm_set1_epi8(31);
+    for (i = 0; i < length; i += 16)
+    {
+        /* the last block overlaps bytes already known not to match */
+        if ((i + 16) > length)
+        {
+            i = length - 16;
+        }
+        chunk = _mm_loadu_si128((const __m128i*)(const void*)(start + i));
+        /* unsigned chunk <= 31 is min(chunk, 31) == chunk */
+        special = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk);
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, quote));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, backslash));
+        mask = (unsigned int)_mm_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return i + first_set(mask);
+        }
+    }
+
+    return length;
+}
+
+static size_t scan_whitespace_sse2(const unsigned char *start, size_t length)
+{
+    __m128i space;
+    __m128i chunk;
+    unsigned int mask = 0;
+    size_t i = 0;
+
+    if (length < 16)
+    {
+        return scan_whitespace_scalar(start, length);
+    }
+
+    space = _mm_set1_epi8(32);
+    for (i = 0; i < length; i += 16)
+    {
+        /* the last block overlaps bytes already known not to match */
+        if ((i + 16) > length)
+        {
+            i = length - 16;
+        }
+        chunk = _mm_loadu_si128((const __m128i*)(const void*)(start + i));
+        mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(chunk, space), chunk)) ^ 0xFFFFu;
+        if (mask != 0)
+        {
+            return i + first_set(mask);
+        }
+    }
+
+    return length;
+}
+
+static const scanners sse2_scanners = { scan_string_sse2, scan_escape_sse2, scan_whitespace_sse2, cJSON_SimdSSE2 };
+
+#ifdef CJSON_SIMD_AVX2
+#if defined(__GNUC__)
+#define CJSON_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CJSON_TARGET_AVX2
+#endif
+
+CJSON_TARGET_AVX2 static size_t scan_string_avx2(const unsigned char *start, size_t length)
+{
+    __m256i quote;
+    __m256i backslash;
+    __m256i chunk;
+    unsigned int mask = 0;
+    size_t i = 0;
+
+    if (length < 32)
+    {
+        return scan_string_sse2(start, length);
+    }
+
+    quote = _mm256_set1_epi8('\"');
+    backslash = _mm256_set1_epi8('\\');
+    for (i = 0; i < length; i += 32)
+    {
+        /* the last block overlaps bytes already known not to match */
+        if ((i + 32) > length)
+        {
+            i = length - 32;
+        }
+        chunk = _mm256_loadu_si256((const __m256i*)(const void*)(start + i));
+        mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)));
+        if (mask != 0)
+        {
+            return i + first_set(mask);
+        }
+    }
+
+    return length;
+}
+
+CJSON_TARGET_AVX2 static size_t scan_escape_avx2(const unsigned char *start, size_t length)
+{
+    __m256i quote;
+    __m256i backslash;
+    __m256i control;
+    __m256i chunk;
+    __m256i special;
+    unsigned int mask = 0;
+    size_t i = 0;
+
+    if (length < 32)
+    {
+        return scan_escape_sse2(start, length);
+    }
+
+    quote = _mm256_set1_epi8('\"');
+    backslash = _mm256_set1_epi8('\\');
+    control = _mm256_set1_epi8(31);
+    for (i = 0; i < length; i += 32)
+    {
+        /* the last block overlaps bytes already known not to match */
+        if ((i + 32) > length)
+        {
+            i = length - 32;
+        }
+        chunk = _mm256_loadu_si256((const __m256i*)(const void*)(start + i));
+        special = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control), chunk);
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, quote));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, backslash));
+        mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return i + first_set(mask);
+        }
+    }
+
+    return length;
+}
+
+CJSON_TARGET_AVX2 static size_t scan_whitespace_avx2(const unsigned char *start, size_t length)
+{
+    __m256i space;
+    __m256i chunk;
+    unsigned int mask = 0;
+    size_t i = 0;
+
+    if (length < 32)
+    {
+        return scan_whitespace_sse2(start, length);
+    }
+
+    space = _mm256_set1_epi8(32);
+    for (i = 0; i < length; i += 32)
+    {
+        /* the last block overlaps bytes already known not to match */
+        if ((i + 32) > length)
+        {
+            i = length - 32;
+        }
+        chunk = _mm256_loadu_si256((const __m256i*)(const void*)(start + i));
+        mask = ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, space), chunk));
+        if (mask != 0)
+        {
+            return i + first_set(mask);
+        }
+    }
+
+    return length;
+}
+
+static const scanners avx2_scanners = { scan_string_avx2, scan_escape_avx2, scan_whitespace_avx2, cJSON_SimdAVX2 };
+
+/* AVX2 needs the CPU to have it and the OS to save the ymm registers */
+static cJSON_bool cpu_has_avx2(void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(info, 1);
+    if (((info[2] & (1 << 27)) == 0) || ((_xgetbv(0) & 6) != 6))
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? true : false;
+#endif
+}
+#endif /* CJSON_SIMD_AVX2 */
+#endif /* CJSON_SIMD_X86 */
+
+static int simd_best_level(void)
+{
+#if defined(CJSON_SIMD_AVX2)
+    if (cpu_has_avx2())
+    {
+        return cJSON_SimdAVX2;
+    }
+#endif
+#if defined(CJSON_SIMD_X86)
+    return cJSON_SimdSSE2;
+#else
+    return cJSON_SimdNone;
+#endif
+}
+
+static const scanners *scanners_for_level(int level)
+{
+#if defined(CJSON_SIMD_AVX2)
+    if (level >= cJSON_SimdAVX2)
+    {
+        return &avx2_scanners;
+    }
+#endif
+#if defined(CJSON_SIMD_X86)
+    if (level >= cJSON_SimdSSE2)
+    {
+        return &sse2_scanners;
+    }
+#endif
+    (void)level;
+    return &scalar_scanners;
+}
+
+/* picked on first use, every thread picks the same */
+static const scanners *active_scanners = NULL;
+
+static const scanners *get_scanners(void)
+{
+    if (active_scanners == NULL)
+    {
+        active_scanners = scanners_for_level(simd_best_level());
+    }
+
+    return active_scanners;
+}
+
+CJSON_PUBLIC(int) cJSON_SetSimdLevel(int level)
+{
+    int best = simd_best_level();
+
+    active_scanners = scanners_for_level((level < best) ? level : best);
+
+    return active_scanners->level;
+}
+
+/* Parse the input text into an unescaped cinput, and populate item. */
+static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const scanners *scan = get_scanners();
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
+    unsigned char *output_pointer = NULL;
+    unsigned char *output = NULL;
+
+    /* not a string */
+    if (buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        goto fail;
+    }
+
+    {
+        /* calculate approximate size of the output (overestimate) */
+        size_t allocation_length = 0;
+        size_t skipped_bytes = 0;
+        while ((size_t)(input_end - input_buffer->content) < input_buffer->length)
+        {
+            /* up to the next quote or escape sequence */
+            input_end += scan->string(input_end, input_buffer->length - (size_t)(input_end - input_buffer->content));
+            if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end == '\"'))
+            {
+                break;
+            }
+
+            if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+            {
+                /* prevent buffer overflow when last input character is a backslash */
+                goto fail;
+            }
+            skipped_bytes++;
+            input_end += 2;
+        }
+        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+        {
+            goto fail; /* string ended unexpectedly */
+        }
+
+        if (input_buffer->insitu)
+        {
+            /* unescaping never lengthens the text, so it can be written back over the literal */
+            output = (unsigned char*)input_pointer;
+        }
+        else
+        {
+            /* This is at most how much we need for the output */
+            allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
+            output = (unsigned char*)hooks_allocate(&input_buffer->hooks, allocation_length + sizeof(""));
+            if (output == NULL)
+            {
+                goto fail; /* allocation failure */
+            }
+        }
+    }
+
+    output_pointer = output;
+    /* loop through the string literal */
+    while (input_pointer < input_end)
     {
         if (*input_pointer != '\\')
         {
-            *output_pointer++ = *input_pointer++;
+            /* copy up to the next escape sequence, there are no quotes before input_end */
+            size_t run = scan->string(input_pointer, (size_t)(input_end - input_pointer));
+            if (!input_buffer->insitu)
+            {
+                memcpy(output_pointer, input_pointer, run);
+            }
+            else if (output_pointer != input_pointer)
+            {
+                /* in place, the output trails the input once an escape was shortened */
+                memmove(output_pointer, input_pointer, run);
+            }
+            output_pointer += run;
+            input_pointer += run;
         }
         /* escape sequence */
         else
@@ -892,11 +1685,15 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
         }
     }
 
-    /* zero terminate the output */
+    /* zero terminate the output, in place this lands at or before the closing quote */
     *output_pointer = '\0';
 
     item->type = cJSON_String;
     item->valuestring = (char*)output;
+    if (input_buffer->insitu)
+    {
+        item->flags |= cJSON_InsituValuestring;
+    }
 
     input_buffer->offset = (size_t) (input_end - input_buffer->content);
     input_buffer->offset++;
@@ -904,9 +1701,9 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
     return true;
 
 fail:
-    if (output != NULL)
+    if ((output != NULL) && !input_buffer->insitu)
     {
-        input_buffer->hooks.deallocate(output);
+        hooks_deallocate(&input_buffer->hooks, output);
         output = NULL;
     }
 
@@ -921,7 +1718,9 @@ fail:
 /* Render the cstring provided to an escaped version that can be printed. */
 static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
 {
+    const scanners *scan = get_scanners();
     const unsigned char *input_pointer = NULL;
+    const unsigned char *input_end = NULL;
     unsigned char *output = NULL;
     unsigned char *output_pointer = NULL;
     size_t output_length = 0;
@@ -946,9 +1745,17 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
         return true;
     }
 
+    input_end = input + strlen((const char*)input);
+
     /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
+    for (input_pointer = input; input_pointer < input_end; input_pointer++)
     {
+        input_pointer += scan->escape(input_pointer, (size_t)(input_end - input_pointer));
+        if (input_pointer == input_end)
+        {
+            break;
+        }
+
         switch (*input_pointer)
         {
             case '\"':
@@ -992,12 +1799,15 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
     output[0] = '\"';
     output_pointer = output + 1;
     /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    for (input_pointer = input; input_pointer < input_end; (void)input_pointer++, output_pointer++)
     {
         if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
         {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
+            /* normal characters, copy up to the next one that isn't */
+            size_t run = scan->escape(input_pointer, (size_t)(input_end - input_pointer));
+            memcpy(output_pointer, input_pointer, run);
+            output_pointer += run - 1;
+            input_pointer += run - 1;
         }
         else
         {
@@ -1067,9 +1877,9 @@ static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
         return buffer;
     }
 
-    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+    if (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
     {
-       buffer->offset++;
+        buffer->offset += get_scanners()->whitespace(buffer_at_offset(buffer), buffer->length - buffer->offset);
     }
 
     if (buffer->offset == buffer->length)
@@ -1112,9 +1922,9 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
 }
 
 /* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+static cJSON *parse(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated, cJSON_bool insitu, const internal_hooks * const hooks)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, 0 }, 0 };
     cJSON *item = NULL;
 
     /* reset error position */
@@ -1129,9 +1939,10 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
     buffer.content = (const unsigned char*)value;
     buffer.length = buffer_length;
     buffer.offset = 0;
-    buffer.hooks = global_hooks;
+    buffer.hooks = *hooks;
+    buffer.insitu = insitu;
 
-    item = cJSON_New_Item(&global_hooks);
+    item = cJSON_New_Item(hooks);
     if (item == NULL) /* memory fail */
     {
         goto fail;
@@ -1191,6 +2002,11 @@ fail:
     return NULL;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    return parse(value, buffer_length, return_parse_end, require_null_terminated, false, &global_hooks);
+}
+
 /* Default options for cJSON_Parse */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
 {
@@ -1202,6 +2018,21 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
     return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_ParseInsitu(char *value)
+{
+    if (value == NULL)
+    {
+        return NULL;
+    }
+
+    return cJSON_ParseInsituWithLength(value, strlen(value) + sizeof(""));
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseInsituWithLength(char *value, size_t buffer_length)
+{
+    return parse(value, buffer_length, NULL, false, true, &global_hooks);
+}
+
 #define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
 
 static unsigned char *print(const cJSON * const item, cJSON_bool format, const internal_hooks * const hooks)
@@ -1213,7 +2044,7 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
     memset(buffer, 0, sizeof(buffer));
 
     /* create buffer */
-    buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
+    buffer->buffer = (unsigned char*) hooks_allocate(hooks, default_buffer_size);
     buffer->length = default_buffer_size;
     buffer->format = format;
     buffer->hooks = *hooks;
@@ -1229,8 +2060,14 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
     }
     update_offset(buffer);
 
+    /* arena memory isn't given back, so there is nothing to gain from shrinking */
+    if (hooks->arena != NULL)
+    {
+        printed = buffer->buffer;
+        buffer->buffer = NULL;
+    }
     /* check if reallocate is available */
-    if (hooks->reallocate != NULL)
+    else if (hooks->reallocate != NULL)
     {
         printed = (unsigned char*) hooks->reallocate(buffer->buffer, buffer->offset + 1);
         if (printed == NULL) {
@@ -1240,7 +2077,7 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
     }
     else /* otherwise copy the JSON over to a new buffer */
     {
-        printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
+        printed = (unsigned char*) hooks_allocate(hooks, buffer->offset + 1);
         if (printed == NULL)
         {
             goto fail;
@@ -1249,7 +2086,7 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
         printed[buffer->offset] = '\0'; /* just to be sure */
 
         /* free the buffer */
-        hooks->deallocate(buffer->buffer);
+        hooks_deallocate(hooks, buffer->buffer);
         buffer->buffer = NULL;
     }
 
@@ -1258,13 +2095,13 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
 fail:
     if (buffer->buffer != NULL)
     {
-        hooks->deallocate(buffer->buffer);
+        hooks_deallocate(hooks, buffer->buffer);
         buffer->buffer = NULL;
     }
 
     if (printed != NULL)
     {
-        hooks->deallocate(printed);
+        hooks_deallocate(hooks, printed);
         printed = NULL;
     }
 
@@ -1282,9 +2119,61 @@ CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item)
     return (char*)print(item, false, &global_hooks);
 }
 
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintStream(const cJSON *item, cJSON_bool format, size_t buffer_size, cJSON_PrintWriter write, void *user)
+{
+    printbuffer p;
+    cJSON_bool success = false;
+
+    if ((item == NULL) || (write == NULL) || (buffer_size == 0))
+    {
+        return false;
+    }
+
+    memset(&p, 0, sizeof(p));
+    p.buffer = (unsigned char*)global_hooks.allocate(buffer_size);
+    if (p.buffer == NULL)
+    {
+        return false;
+    }
+    p.length = buffer_size;
+    p.format = format;
+    p.hooks = global_hooks;
+    p.write = write;
+    p.write_user = user;
+
+    if (print_value(item, &p))
+    {
+        update_offset(&p);
+        success = (p.offset == 0) || write(user, (const char*)p.buffer, p.offset);
+    }
+
+    /* ensure frees the buffer if growing it failed */
+    if (p.buffer != NULL)
+    {
+        global_hooks.deallocate(p.buffer);
+    }
+
+    return success;
+}
+
+static cJSON_bool write_file(void *user, const char *data, size_t length)
+{
+    return fwrite(data, 1, length, (FILE*)user) == length;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintToFile(const cJSON *item, cJSON_bool format, FILE *file)
+{
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    return cJSON_PrintStream(item, format, CJSON_PRINT_STREAM_BUFFER, write_file, file);
+}
+
 CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, 0 }, 0, 0 };
 
     if (prebuffer < 0)
     {
@@ -1315,7 +2204,7 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, 0 }, 0, 0 };
 
     if ((length < 0) || (buffer == NULL))
     {
@@ -1695,6 +2584,10 @@ static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_bu
         /* swap valuestring and string, because we parsed the name */
         current_item->string = current_item->valuestring;
         current_item->valuestring = NULL;
+        if (current_item->flags & cJSON_InsituValuestring)
+        {
+            current_item->flags = (current_item->flags & ~cJSON_InsituValuestring) | cJSON_InsituString;
+        }
 
         if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
         {
@@ -1864,6 +2757,11 @@ CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
         return 0;
     }
 
+    if ((array->index != NULL) && cJSON_IsArray(array))
+    {
+        return (int)array->index->count;
+    }
+
     child = array->child;
 
     while(child != NULL)
@@ -1886,6 +2784,11 @@ static cJSON* get_array_item(const cJSON *array, size_t index)
         return NULL;
     }
 
+    if ((array->index != NULL) && cJSON_IsArray(array))
+    {
+        return (index < array->index->count) ? array->index->items[index] : NULL;
+    }
+
     current_child = array->child;
     while ((current_child != NULL) && (index > 0))
     {
@@ -1906,15 +2809,229 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
     return get_array_item(array, (size_t)index);
 }
 
+static void object_index_insert(struct cJSON_Index * const index, cJSON * const item)
+{
+    size_t mask = index->size - 1;
+    size_t slot = item_key_hash(item) & mask;
+
+    while (index->items[slot] != NULL)
+    {
+        slot = (slot + 1) & mask;
+    }
+    index->items[slot] = item;
+    index->count++;
+}
+
+static void object_index_build(cJSON * const object)
+{
+    struct cJSON_Index *index = NULL;
+    cJSON *child = NULL;
+    size_t count = 0;
+    size_t size = 16;
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        if (child->string == NULL)
+        {
+            return; /* not an object's member */
+        }
+        count++;
+    }
+    while ((size / 2) < count)
+    {
+        size *= 2;
+    }
+
+    index = (struct cJSON_Index*)global_hooks.allocate(sizeof(struct cJSON_Index));
+    if (index == NULL)
+    {
+        return;
+    }
+    index->items = (cJSON**)global_hooks.allocate(size * sizeof(cJSON*));
+    if (index->items == NULL)
+    {
+        global_hooks.deallocate(index);
+        return;
+    }
+    memset(index->items, '\0', size * sizeof(cJSON*));
+    index->count = 0;
+    index->size = size;
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        object_index_insert(index, child);
+    }
+    object->index = index;
+}
+
+/* Room for count items in an array's index */
+static cJSON_bool array_index_reserve(struct cJSON_Index * const index, size_t count)
+{
+    cJSON **items = NULL;
+    size_t size = (index->size > 0) ? index->size : 16;
+
+    if (count <= index->size)
+    {
+        return true;
+    }
+    while (size < count)
+    {
+        if (size > (((size_t)-1) / (2 * sizeof(cJSON*))))
+        {
+            return false;
+        }
+        size *= 2;
+    }
+
+    if (global_hooks.reallocate != NULL)
+    {
+        items = (cJSON**)global_hooks.reallocate(index->items, size * sizeof(cJSON*));
+    }
+    else
+    {
+        items = (cJSON**)global_hooks.allocate(size * sizeof(cJSON*));
+        if ((items != NULL) && (index->items != NULL))
+        {
+            memcpy(items, index->items, index->count * sizeof(cJSON*));
+            global_hooks.deallocate(index->items);
+        }
+    }
+    if (items == NULL)
+    {
+        return false;
+    }
+    index->items = items;
+    index->size = size;
+
+    return true;
+}
+
+static struct cJSON_Index *array_index_build(const cJSON * const array)
+{
+    struct cJSON_Index *index = NULL;
+    cJSON *child = NULL;
+    size_t count = 0;
+
+    index = (struct cJSON_Index*)global_hooks.allocate(sizeof(struct cJSON_Index));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    memset(index, '\0', sizeof(struct cJSON_Index));
+
+    for (child = array->child; child != NULL; child = child->next)
+    {
+        count++;
+    }
+    if (!array_index_reserve(index, count))
+    {
+        global_hooks.deallocate(index);
+        return NULL;
+    }
+    for (child = array->child; child != NULL; child = child->next)
+    {
+        index->items[index->count++] = child;
+    }
+
+    return index;
+}
+
+/* Position of an item in an array's index, count if it isn't there */
+static size_t array_index_find(const struct cJSON_Index * const index, const cJSON * const item)
+{
+    size_t position = 0;
+
+    while ((position < index->count) && (index->items[position] != item))
+    {
+        position++;
+    }
+
+    return position;
+}
+
+/* Keeps an index in step with an appended child, or drops it */
+static void index_add(cJSON * const parent, cJSON * const item)
+{
+    struct cJSON_Index *index = parent->index;
+
+    if (index == NULL)
+    {
+        return;
+    }
+
+    if (cJSON_IsObject(parent))
+    {
+        if (item->string == NULL)
+        {
+            index_free(parent);
+            return;
+        }
+        if ((index->count + 1) > (index->size / 2))
+        {
+            /* asked for explicitly, so grow it rather than lose it; item is already in the list */
+            index_free(parent);
+            object_index_build(parent);
+            return;
+        }
+        object_index_insert(index, item);
+    }
+    else
+    {
+        if (!array_index_reserve(index, index->count + 1))
+        {
+            index_free(parent);
+            return;
+        }
+        index->items[index->count++] = item;
+    }
+}
+
+static cJSON_bool key_equal(const char * const name, const cJSON * const item, const cJSON_bool case_sensitive)
+{
+    if (case_sensitive)
+    {
+        return strcmp(name, item->string) == 0;
+    }
+
+    return case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)item->string) == 0;
+}
+
 static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
 {
     cJSON *current_element = NULL;
+    struct cJSON_Index *index = NULL;
+    unsigned int hash = 0;
+    size_t slot = 0;
 
     if ((object == NULL) || (name == NULL))
     {
         return NULL;
     }
 
+    index = cJSON_IsObject(object) ? object->index : NULL;
+    if (index != NULL)
+    {
+        hash = key_hash((const unsigned char*)name);
+        for (slot = hash & (index->size - 1); index->items[slot] != NULL; slot = (slot + 1) & (index->size - 1))
+        {
+            if ((index->items[slot]->hash != hash) || !key_equal(name, index->items[slot], case_sensitive))
+            {
+                continue;
+            }
+            if (current_element != NULL)
+            {
+                /* a repeated key, only the list knows which one comes first */
+                current_element = NULL;
+                break;
+            }
+            current_element = index->items[slot];
+        }
+        if ((current_element != NULL) || (index->items[slot] == NULL))
+        {
+            return current_element;
+        }
+    }
+
     current_element = object->child;
     if (case_sensitive)
     {
@@ -1964,6 +3081,7 @@ static void suffix_object(cJSON *prev, cJSON *item)
 static cJSON *create_reference(const cJSON *item, const internal_hooks * const hooks)
 {
     cJSON *reference = NULL;
+    int flags = 0;
     if (item == NULL)
     {
         return NULL;
@@ -1975,7 +3093,11 @@ static cJSON *create_reference(const cJSON *item, const internal_hooks * const h
         return NULL;
     }
 
+    /* the reference's memory is its own, whoever owns the item's */
+    flags = reference->flags;
     memcpy(reference, item, sizeof(cJSON));
+    reference->flags = flags;
+    reference->index = NULL;
     reference->string = NULL;
     reference->type |= cJSON_IsReference;
     reference->next = reference->prev = NULL;
@@ -2011,6 +3133,7 @@ static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
             array->child->prev = item;
         }
     }
+    index_add(array, item);
 
     return true;
 }
@@ -2063,13 +3186,18 @@ static cJSON_bool add_item_to_object(cJSON * const object, const char * const st
         new_type = item->type & ~cJSON_StringIsConst;
     }
 
-    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
+    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL) && !(item->flags & (cJSON_ArenaString | cJSON_InsituString)))
     {
-        hooks->deallocate(item->string);
+        hooks_deallocate(hooks, item->string);
     }
 
     item->string = new_key;
     item->type = new_type;
+    item->flags &= ~(cJSON_KeyHashed | cJSON_InsituString);
+    if (hooks->arena == NULL)
+    {
+        item->flags &= ~cJSON_ArenaString;
+    }
 
     return add_item_to_array(object, item);
 }
@@ -2215,6 +3343,8 @@ CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * c
 
 CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const item)
 {
+    size_t position = 0;
+
     if ((parent == NULL) || (item == NULL) || (item != parent->child && item->prev == NULL))
     {
         return NULL;
@@ -2246,6 +3376,20 @@ CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const it
     item->prev = NULL;
     item->next = NULL;
 
+    if ((parent->index != NULL) && cJSON_IsArray(parent))
+    {
+        position = array_index_find(parent->index, item);
+        if (position < parent->index->count)
+        {
+            memmove(parent->index->items + position, parent->index->items + position + 1, (parent->index->count - position - 1) * sizeof(cJSON*));
+            parent->index->count--;
+        }
+    }
+    else
+    {
+        index_free(parent);
+    }
+
     return item;
 }
 
@@ -2320,11 +3464,24 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON
     {
         newitem->prev->next = newitem;
     }
+
+    if ((array->index != NULL) && cJSON_IsArray(array) && array_index_reserve(array->index, array->index->count + 1))
+    {
+        memmove(array->index->items + which + 1, array->index->items + which, (array->index->count - (size_t)which) * sizeof(cJSON*));
+        array->index->items[which] = newitem;
+        array->index->count++;
+    }
+    else
+    {
+        index_free(array);
+    }
     return true;
 }
 
 CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON * const item, cJSON * replacement)
 {
+    size_t position = 0;
+
     if ((parent == NULL) || (parent->child == NULL) || (replacement == NULL) || (item == NULL))
     {
         return false;
@@ -2365,6 +3522,19 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON
         }
     }
 
+    if ((parent->index != NULL) && cJSON_IsArray(parent))
+    {
+        position = array_index_find(parent->index, item);
+        if (position < parent->index->count)
+        {
+            parent->index->items[position] = replacement;
+        }
+    }
+    else
+    {
+        index_free(parent);
+    }
+
     item->next = NULL;
     item->prev = NULL;
     cJSON_Delete(item);
@@ -2390,11 +3560,12 @@ static cJSON_bool replace_item_in_object(cJSON *object, const char *string, cJSO
     }
 
     /* replace the name in the replacement */
-    if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+    if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL) && !(replacement->flags & (cJSON_ArenaString | cJSON_InsituString)))
     {
         cJSON_free(replacement->string);
     }
     replacement->string = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
+    replacement->flags &= ~(cJSON_ArenaString | cJSON_InsituString | cJSON_KeyHashed);
     if (replacement->string == NULL)
     {
         return false;
@@ -2737,14 +3908,14 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int co
 }
 
 /* Duplication */
-cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse);
+cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse, const internal_hooks * const hooks);
 
 CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
 {
-    return cJSON_Duplicate_rec(item, 0, recurse );
+    return cJSON_Duplicate_rec(item, 0, recurse, &global_hooks);
 }
 
-cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
+cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse, const internal_hooks * const hooks)
 {
     cJSON *newitem = NULL;
     cJSON *child = NULL;
@@ -2757,7 +3928,7 @@ cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
         goto fail;
     }
     /* Create new item */
-    newitem = cJSON_New_Item(&global_hooks);
+    newitem = cJSON_New_Item(hooks);
     if (!newitem)
     {
         goto fail;
@@ -2768,7 +3939,7 @@ cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
     newitem->valuedouble = item->valuedouble;
     if (item->valuestring)
     {
-        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, &global_hooks);
+        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, hooks);
         if (!newitem->valuestring)
         {
             goto fail;
@@ -2776,7 +3947,7 @@ cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
     }
     if (item->string)
     {
-        newitem->string = (item->type&cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, &global_hooks);
+        newitem->string = (item->type&cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, hooks);
         if (!newitem->string)
         {
             goto fail;
@@ -2794,7 +3965,7 @@ cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
         if(depth >= CJSON_CIRCULAR_LIMIT) {
             goto fail;
         }
-        newchild = cJSON_Duplicate_rec(child, depth + 1, true); /* Duplicate (with recurse) each item in the ->next chain */
+        newchild = cJSON_Duplicate_rec(child, depth + 1, true, hooks); /* Duplicate (with recurse) each item in the ->next chain */
         if (!newchild)
         {
             goto fail;
@@ -3162,3 +4333,630 @@ CJSON_PUBLIC(void) cJSON_free(void *object)
     global_hooks.deallocate(object);
     object = NULL;
 }
+
+CJSON_PUBLIC(cJSON_Arena *) cJSON_ArenaCreate(size_t chunk_size)
+{
+    cJSON_Arena *arena = (cJSON_Arena*)global_hooks.allocate(sizeof(cJSON_Arena));
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+    memset(arena, '\0', sizeof(cJSON_Arena));
+
+    if (chunk_size == 0)
+    {
+        chunk_size = CJSON_ARENA_CHUNK_SIZE;
+    }
+    arena->chunk_size = arena_align(chunk_size);
+    arena->chunk_hooks = global_hooks;
+    arena->hooks = global_hooks;
+    arena->hooks.reallocate = NULL;
+    arena->hooks.arena = arena;
+
+    return arena;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ArenaParse(cJSON_Arena *arena, const char *value)
+{
+    if (value == NULL)
+    {
+        return NULL;
+    }
+
+    return cJSON_ArenaParseWithLength(arena, value, strlen(value) + sizeof(""));
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ArenaParseWithLength(cJSON_Arena *arena, const char *value, size_t buffer_length)
+{
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    return parse(value, buffer_length, NULL, false, false, &arena->hooks);
+}
+
+CJSON_PUBLIC(char *) cJSON_ArenaPrint(cJSON_Arena *arena, const cJSON *item)
+{
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    return (char*)print(item, true, &arena->hooks);
+}
+
+CJSON_PUBLIC(char *) cJSON_ArenaPrintUnformatted(cJSON_Arena *arena, const cJSON *item)
+{
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    return (char*)print(item, false, &arena->hooks);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ArenaDuplicate(cJSON_Arena *arena, const cJSON *item, cJSON_bool recurse)
+{
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    return cJSON_Duplicate_rec(item, 0, recurse, &arena->hooks);
+}
+
+CJSON_PUBLIC(void) cJSON_ArenaReset(cJSON_Arena *arena)
+{
+    arena_chunk *chunk = NULL;
+    arena_chunk *next = NULL;
+    arena_chunk *kept = NULL;
+
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    for (chunk = arena->chunks; chunk != NULL; chunk = next)
+    {
+        next = chunk->next;
+        if ((kept == NULL) && (chunk->size == arena->chunk_size))
+        {
+            kept = chunk;
+            kept->next = NULL;
+            kept->used = 0;
+            kept->last = 0;
+        }
+        else
+        {
+            arena->chunk_hooks.deallocate(chunk);
+        }
+    }
+    arena->chunks = kept;
+}
+
+CJSON_PUBLIC(void) cJSON_ArenaDelete(cJSON_Arena *arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    cJSON_ArenaReset(arena);
+    if (arena->chunks != NULL)
+    {
+        arena->chunk_hooks.deallocate(arena->chunks);
+    }
+    arena->chunk_hooks.deallocate(arena);
+}
+
+typedef enum
+{
+    sax_value,        /* a value, at the top, after ':' or after ',' in an array */
+    sax_array_first,  /* a value or ']' */
+    sax_object_first, /* a key or '}' */
+    sax_key,          /* after ',' in an object */
+    sax_colon,
+    sax_next,         /* after a value in a container, ',' or its end */
+    sax_done,
+    sax_failed
+} sax_state;
+
+typedef enum
+{
+    sax_progress,
+    sax_more, /* the token continues past the end of the input so far */
+    sax_error
+} sax_result;
+
+struct cJSON_Sax
+{
+    cJSON_SaxHandler handler;
+    void *user;
+    internal_hooks hooks; /* for the pending input */
+    cJSON_Arena *arena; /* the current string, reset after its callback */
+
+    unsigned char *buffer; /* input not consumed yet */
+    size_t length;
+    size_t capacity;
+    size_t consumed; /* bytes dropped from the front of buffer */
+    cJSON_bool started; /* past the BOM */
+    size_t scanned; /* where the pending string's closing quote search resumes, from its opening quote, 0 for none */
+
+    sax_state state;
+    size_t depth;
+    unsigned char objects[CJSON_NESTING_LIMIT]; /* per open container, true for an object */
+};
+
+static sax_result sax_callback(cJSON_Sax * const sax, cJSON_bool (*callback)(void *user))
+{
+    if ((callback != NULL) && !callback(sax->user))
+    {
+        return sax_error;
+    }
+
+    return sax_progress;
+}
+
+static void sax_after_value(cJSON_Sax * const sax)
+{
+    sax->state = (sax->depth == 0) ? sax_done : sax_next;
+}
+
+static sax_result sax_open(cJSON_Sax * const sax, parse_buffer * const input, cJSON_bool object)
+{
+    if (sax->depth >= CJSON_NESTING_LIMIT)
+    {
+        return sax_error; /* too deeply nested */
+    }
+    input->offset++;
+    sax->objects[sax->depth++] = (unsigned char)object;
+    sax->state = object ? sax_object_first : sax_array_first;
+
+    return sax_callback(sax, object ? sax->handler.start_object : sax->handler.start_array);
+}
+
+static sax_result sax_close(cJSON_Sax * const sax, parse_buffer * const input, cJSON_bool object)
+{
+    input->offset++;
+    sax->depth--;
+    sax_after_value(sax);
+
+    return sax_callback(sax, object ? sax->handler.end_object : sax->handler.end_array);
+}
+
+static sax_result sax_string(cJSON_Sax * const sax, parse_buffer * const input, cJSON_bool final, cJSON_bool key)
+{
+    const scanners *scan = get_scanners();
+    const unsigned char *start = buffer_at_offset(input);
+    const unsigned char *end = start + ((sax->scanned != 0) ? sax->scanned : 1);
+    const unsigned char *limit = input->content + input->length;
+    cJSON item;
+    cJSON_bool success = true;
+
+    /* parse_string needs the closing quote, look for it only in what the last chunks didn't have */
+    while (end < limit)
+    {
+        end += scan->string(end, (size_t)(limit - end));
+        if ((end >= limit) || (*end == '\"'))
+        {
+            break;
+        }
+        end += 2; /* an escape, past limit if it was the last byte, so the next chunk skips the escaped one */
+    }
+    if (end >= limit)
+    {
+        sax->scanned = (size_t)(end - start);
+        return final ? sax_error : sax_more;
+    }
+    sax->scanned = 0;
+
+    memset(&item, '\0', sizeof(item));
+    if (!parse_string(&item, input))
+    {
+        return sax_error;
+    }
+
+    if (key)
+    {
+        sax->state = sax_colon;
+        success = (sax->handler.key == NULL) || sax->handler.key(sax->user, item.valuestring);
+    }
+    else
+    {
+        sax_after_value(sax);
+        success = (sax->handler.string == NULL) || sax->handler.string(sax->user, item.valuestring);
+    }
+    cJSON_ArenaReset(sax->arena);
+
+    return success ? sax_progress : sax_error;
+}
+
+static cJSON_bool sax_number_char(unsigned char c)
+{
+    return ((c >= '0') && (c <= '9')) || (c == '+') || (c == '-') || (c == '.') || (c == 'e') || (c == 'E');
+}
+
+static sax_result sax_number(cJSON_Sax * const sax, parse_buffer * const input, cJSON_bool final)
+{
+    size_t i = 0;
+    cJSON item;
+
+    /* parse_number needs what follows the number, or the end of the input */
+    while (can_access_at_index(input, i) && sax_number_char(buffer_at_offset(input)[i]))
+    {
+        i++;
+    }
+    if (cannot_access_at_index(input, i) && !final)
+    {
+        return sax_more;
+    }
+
+    memset(&item, '\0', sizeof(item));
+    if (!parse_number(&item, input))
+    {
+        return sax_error;
+    }
+    sax_after_value(sax);
+
+    if ((sax->handler.number != NULL) && !sax->handler.number(sax->user, item.valuedouble))
+    {
+        return sax_error;
+    }
+
+    return sax_progress;
+}
+
+static sax_result sax_literal(cJSON_Sax * const sax, parse_buffer * const input, cJSON_bool final)
+{
+    static const char *literals[] = { "null", "false", "true" };
+    size_t available = input->length - input->offset;
+    size_t length = 0;
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(literals) / sizeof(literals[0])); i++)
+    {
+        length = strlen(literals[i]);
+        if (strncmp((const char*)buffer_at_offset(input), literals[i], cjson_min(available, length)) != 0)
+        {
+            continue;
+        }
+        if (available < length)
+        {
+            return final ? sax_error : sax_more;
+        }
+
+        input->offset += length;
+        sax_after_value(sax);
+        if (i == 0)
+        {
+            return sax_callback(sax, sax->handler.null);
+        }
+        if ((sax->handler.boolean != NULL) && !sax->handler.boolean(sax->user, i == 2))
+        {
+            return sax_error;
+        }
+        return sax_progress;
+    }
+
+    return sax_error;
+}
+
+static sax_result sax_value_at(cJSON_Sax * const sax, parse_buffer * const input, cJSON_bool final)
+{
+    unsigned char c = buffer_at_offset(input)[0];
+
+    if ((c == '{') || (c == '['))
+    {
+        return sax_open(sax, input, c == '{');
+    }
+    if (c == '\"')
+    {
+        return sax_string(sax, input, final, false);
+    }
+    if ((c == '-') || ((c >= '0') && (c <= '9')))
+    {
+        return sax_number(sax, input, final);
+    }
+
+    return sax_literal(sax, input, final);
+}
+
+/* One token, or as far as the input goes */
+static sax_result sax_step(cJSON_Sax * const sax, parse_buffer * const input, cJSON_bool final)
+{
+    unsigned char c = 0;
+    cJSON_bool object = (sax->depth > 0) && sax->objects[sax->depth - 1];
+
+    if (can_access_at_index(input, 0) && (buffer_at_offset(input)[0] <= 32))
+    {
+        input->offset += get_scanners()->whitespace(buffer_at_offset(input), input->length - input->offset);
+    }
+    if (cannot_access_at_index(input, 0))
+    {
+        return final ? sax_error : sax_more;
+    }
+    c = buffer_at_offset(input)[0];
+
+    switch (sax->state)
+    {
+        case sax_value:
+            return sax_value_at(sax, input, final);
+
+        case sax_array_first:
+            if (c == ']')
+            {
+                return sax_close(sax, input, false);
+            }
+            return sax_value_at(sax, input, final);
+
+        case sax_object_first:
+            if (c == '}')
+            {
+                return sax_close(sax, input, true);
+            }
+            return (c == '\"') ? sax_string(sax, input, final, true) : sax_error;
+
+        case sax_key:
+            return (c == '\"') ? sax_string(sax, input, final, true) : sax_error;
+
+        case sax_colon:
+            if (c != ':')
+            {
+                return sax_error;
+            }
+            input->offset++;
+            sax->state = sax_value;
+            return sax_progress;
+
+        case sax_next:
+            if (c == ',')
+            {
+                input->offset++;
+                sax->state = object ? sax_key : sax_value;
+                return sax_progress;
+            }
+            if (c == (object ? '}' : ']'))
+            {
+                return sax_close(sax, input, object);
+            }
+            return sax_error;
+
+        default:
+            return sax_error;
+    }
+}
+
+static cJSON_bool sax_run(cJSON_Sax * const sax, cJSON_bool final)
+{
+    parse_buffer input = { 0, 0, 0, 0, { 0, 0, 0, 0 }, 0 };
+    sax_result result = sax_progress;
+
+    input.content = sax->buffer;
+    input.length = sax->length;
+    input.hooks = sax->arena->hooks;
+
+    if (!sax->started)
+    {
+        /* skip the UTF-8 BOM once there are enough bytes to tell */
+        if ((input.length < 3) && !final && ((input.length == 0) || (memcmp(input.content, "\xEF\xBB\xBF", input.length) == 0)))
+        {
+            return true;
+        }
+        if ((input.length >= 3) && (memcmp(input.content, "\xEF\xBB\xBF", 3) == 0))
+        {
+            input.offset = 3;
+        }
+        sax->started = true;
+    }
+
+    while ((sax->state != sax_done) && (result == sax_progress))
+    {
+        result = sax_step(sax, &input, final);
+    }
+
+    sax->consumed += input.offset;
+    if (result == sax_error)
+    {
+        sax->state = sax_failed;
+        return false;
+    }
+    if (sax->state == sax_done)
+    {
+        /* like cJSON_Parse, whatever follows the document is ignored */
+        sax->length = 0;
+        return true;
+    }
+
+    /* keep the unfinished token for the next chunk */
+    memmove(sax->buffer, sax->buffer + input.offset, sax->length - input.offset);
+    sax->length -= input.offset;
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_Sax *) cJSON_SaxCreate(const cJSON_SaxHandler *handler, void *user)
+{
+    cJSON_Sax *sax = NULL;
+
+    if (handler == NULL)
+    {
+        return NULL;
+    }
+
+    sax = (cJSON_Sax*)global_hooks.allocate(sizeof(cJSON_Sax));
+    if (sax == NULL)
+    {
+        return NULL;
+    }
+    memset(sax, '\0', sizeof(cJSON_Sax));
+
+    sax->arena = cJSON_ArenaCreate(0);
+    if (sax->arena == NULL)
+    {
+        global_hooks.deallocate(sax);
+        return NULL;
+    }
+    sax->handler = *handler;
+    sax->user = user;
+    sax->hooks = global_hooks;
+    sax->state = sax_value;
+
+    return sax;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_SaxFeed(cJSON_Sax *sax, const char *chunk, size_t length)
+{
+    unsigned char *newbuffer = NULL;
+    size_t newsize = 0;
+
+    if ((sax == NULL) || ((chunk == NULL) && (length > 0)) || (sax->state == sax_failed))
+    {
+        return false;
+    }
+    if (sax->state == sax_done)
+    {
+        return true;
+    }
+
+    if (length > (sax->capacity - sax->length))
+    {
+        if (length > ((((size_t)-1) / 2) - sax->length))
+        {
+            return false;
+        }
+        newsize = (sax->length + length) * 2;
+
+        if (sax->hooks.reallocate != NULL)
+        {
+            newbuffer = (unsigned char*)sax->hooks.reallocate(sax->buffer, newsize);
+        }
+        else
+        {
+            newbuffer = (unsigned char*)sax->hooks.allocate(newsize);
+            if ((newbuffer != NULL) && (sax->buffer != NULL))
+            {
+                memcpy(newbuffer, sax->buffer, sax->length);
+                sax->hooks.deallocate(sax->buffer);
+            }
+        }
+        if (newbuffer == NULL)
+        {
+            return false;
+        }
+        sax->buffer = newbuffer;
+        sax->capacity = newsize;
+    }
+    if (length > 0)
+    {
+        memcpy(sax->buffer + sax->length, chunk, length);
+        sax->length += length;
+    }
+
+    return sax_run(sax, false);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_SaxFinish(cJSON_Sax *sax)
+{
+    if ((sax == NULL) || (sax->state == sax_failed))
+    {
+        return false;
+    }
+    if (sax->state != sax_done)
+    {
+        sax_run(sax, true);
+    }
+
+    return sax->state == sax_done;
+}
+
+CJSON_PUBLIC(size_t) cJSON_SaxOffset(const cJSON_Sax *sax)
+{
+    return (sax != NULL) ? sax->consumed : 0;
+}
+
+CJSON_PUBLIC(void) cJSON_SaxDelete(cJSON_Sax *sax)
+{
+    if (sax == NULL)
+    {
+        return;
+    }
+
+    if (sax->buffer != NULL)
+    {
+        sax->hooks.deallocate(sax->buffer);
+    }
+    cJSON_ArenaDelete(sax->arena);
+    sax->hooks.deallocate(sax);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IndexObject(cJSON *object)
+{
+    if (!cJSON_IsObject(object) || (object->type & cJSON_IsReference) || (object->flags & cJSON_ArenaItem))
+    {
+        return false;
+    }
+    if (object->index == NULL)
+    {
+        object_index_build(object);
+    }
+
+    return object->index != NULL;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IndexArray(cJSON *array)
+{
+    if (!cJSON_IsArray(array) || (array->type & cJSON_IsReference) || (array->flags & cJSON_ArenaItem))
+    {
+        return false;
+    }
+    if (array->index == NULL)
+    {
+        array->index = array_index_build(array);
+    }
+
+    return array->index != NULL;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_SortArray(cJSON *array, int (*compare)(const void *a, const void *b))
+{
+    struct cJSON_Index *index = NULL;
+    cJSON **items = NULL;
+    size_t count = 0;
+    size_t i = 0;
+
+    if (!cJSON_IsArray(array) || (compare == NULL))
+    {
+        return false;
+    }
+
+    /* arrays that can't keep an index are sorted through a temporary one */
+    index = cJSON_IndexArray(array) ? array->index : array_index_build(array);
+    if (index == NULL)
+    {
+        return false;
+    }
+    items = index->items;
+    count = index->count;
+
+    if (count > 1)
+    {
+        qsort(items, count, sizeof(cJSON*), compare);
+
+        /* relink the same items in the new order, child->prev is the last one */
+        for (i = 0; i < count; i++)
+        {
+            items[i]->prev = (i > 0) ? items[i - 1] : items[count - 1];
+            items[i]->next = ((i + 1) < count) ? items[i + 1] : NULL;
+        }
+        array->child = items[0];
+    }
+
+    if (index != array->index)
+    {
+        global_hooks.deallocate(index->items);
+        global_hooks.deallocate(index);
+    }
+
+    return true;
+}
@@ -84,6 +84,7 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 #define CJSON_VERSION_PATCH 18
 
 #include <stddef.h>
+#include <stdio.h>
 
 /* cJSON Types: */
 #define cJSON_Invalid (0)
@@ -99,6 +100,14 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
 
+/* cJSON Flags, which allocations of an item belong to an arena or the parsed buffer and what is cached on it: */
+#define cJSON_ArenaItem         (1 << 0)
+#define cJSON_ArenaValuestring  (1 << 1)
+#define cJSON_ArenaString       (1 << 2)
+#define cJSON_KeyHashed         (1 << 3)
+#define cJSON_InsituValuestring (1 << 4)
+#define cJSON_InsituString      (1 << 5)
+
 /* The cJSON structure: */
 typedef struct cJSON
 {
@@ -110,16 +119,24 @@ typedef struct cJSON
 
     /* The type of the item, as above. */
     int type;
+    /* Where the item's memory came from, see cJSON Flags. cJSON_Delete skips anything owned by an arena. */
+    int flags;
 
     /* The item's string, if type==cJSON_String  and type == cJSON_Raw */
     char *valuestring;
     /* writing to valueint is DEPRECATED, use cJSON_SetNumberValue instead */
     int valueint;
+    /* Case folded hash of string, cached on the first lookup that needs it when cJSON_KeyHashed is set. */
+    unsigned int hash;
     /* The item's number, if type==cJSON_Number */
     double valuedouble;
 
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
+
+    /* Built only by cJSON_IndexObject and cJSON_IndexArray, then kept in step or dropped by the functions
+     * that change the children. Relinking the children by hand leaves it stale. */
+    struct cJSON_Index *index;
 } cJSON;
 
 typedef struct cJSON_Hooks
@@ -143,12 +160,32 @@ typedef int cJSON_bool;
 #define CJSON_CIRCULAR_LIMIT 10000
 #endif
 
+/* Default size of the buffer cJSON_PrintToFile writes through. */
+#ifndef CJSON_PRINT_STREAM_BUFFER
+#define CJSON_PRINT_STREAM_BUFFER (16 * 1024)
+#endif
+
+/* Default size of the chunks an arena carves its allocations from. */
+#ifndef CJSON_ARENA_CHUNK_SIZE
+#define CJSON_ARENA_CHUNK_SIZE (64 * 1024)
+#endif
+
+/* Vector instructions used to scan strings and whitespace, the best the CPU has is picked on first use.
+ * Build with CJSON_DISABLE_SIMD for the scalar code only. */
+#define cJSON_SimdNone 0
+#define cJSON_SimdSSE2 1
+#define cJSON_SimdAVX2 2
+
 /* returns the version of cJSON as a string */
 CJSON_PUBLIC(const char*) cJSON_Version(void);
 
 /* Supply malloc, realloc and free functions to cJSON */
 CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks);
 
+/* Caps the vector instructions cJSON scans with, cJSON_SimdNone for the scalar code. Returns the level in use,
+ * which is lower than asked for if the CPU or build doesn't have it. Not thread safe against running parses. */
+CJSON_PUBLIC(int) cJSON_SetSimdLevel(int level);
+
 /* Memory Management: the caller is always responsible to free the results from all variants of cJSON_Parse (with cJSON_Delete) and cJSON_Print (with stdlib free, cJSON_Hooks.free_fn, or cJSON_free as appropriate). The exception is cJSON_PrintPreallocated, where the caller has full responsibility of the buffer. */
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate. */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value);
@@ -157,6 +194,10 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 /* If you supply a ptr in return_parse_end and parsing fails, then return_parse_end will contain a pointer to the error so will match cJSON_GetErrorPtr(). */
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
+/* ParseInsitu unescapes strings and keys into value itself instead of copying them, so the tree's valuestring and
+ * string point into it. value is overwritten (also when parsing fails) and must outlive the cJSON_Delete of the tree. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseInsitu(char *value);
+CJSON_PUBLIC(cJSON *) cJSON_ParseInsituWithLength(char *value, size_t buffer_length);
 
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
@@ -167,6 +208,13 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* Render a cJSON entity through a buffer of buffer_size bytes, handing it to write whenever it fills, so only the buffer
+ * is held rather than the whole text. A single string longer than the buffer grows it. write returns false to stop,
+ * and so does the print. */
+typedef cJSON_bool (*cJSON_PrintWriter)(void *user, const char *data, size_t length);
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintStream(const cJSON *item, cJSON_bool format, size_t buffer_size, cJSON_PrintWriter write, void *user);
+/* cJSON_PrintStream into a file with a buffer of CJSON_PRINT_STREAM_BUFFER bytes. Returns false if a write failed. */
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintToFile(const cJSON *item, cJSON_bool format, FILE *file);
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item);
 
@@ -251,6 +299,18 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON
 CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObject(cJSON *object,const char *string,cJSON *newitem);
 CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObjectCaseSensitive(cJSON *object,const char *string,cJSON *newitem);
 
+/* Keep a hash of an object's keys next to its list, so cJSON_GetObjectItem and its variants don't walk it.
+ * Adding members keeps it in step, detaching or replacing one drops it until the next call. Lookups never
+ * build one, so they stay pure reads on a shared tree. Not for arena items, returns false if it couldn't
+ * be built. */
+CJSON_PUBLIC(cJSON_bool) cJSON_IndexObject(cJSON *object);
+/* Keep a vector of an array's items next to its list, so cJSON_GetArrayItem and cJSON_GetArraySize are O(1).
+ * The add, insert, detach and replace functions keep it in step. Not for arena items, returns false if it
+ * couldn't be built. */
+CJSON_PUBLIC(cJSON_bool) cJSON_IndexArray(cJSON *array);
+/* Sort an array in place, compare gets two cJSON ** like a qsort comparator. Indexes the array first. */
+CJSON_PUBLIC(cJSON_bool) cJSON_SortArray(cJSON *array, int (*compare)(const void *a, const void *b));
+
 /* Duplicate a cJSON item */
 CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse);
 /* Duplicate will create a new, identical cJSON item to the one you pass, in new memory that will
@@ -299,6 +359,49 @@ CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
 CJSON_PUBLIC(void *) cJSON_malloc(size_t size);
 CJSON_PUBLIC(void) cJSON_free(void *object);
 
+/* Arenas: a document parsed, printed or duplicated into an arena is bump allocated from large chunks
+ * instead of one allocation per item and string, and all of it is released at once by cJSON_ArenaReset
+ * or cJSON_ArenaDelete. Don't cJSON_free what the arena printed. cJSON_Delete on arena items is safe but
+ * only frees what was added to them from the heap later. chunk_size 0 uses CJSON_ARENA_CHUNK_SIZE, the
+ * chunks come from the hooks set when the arena is created. */
+typedef struct cJSON_Arena cJSON_Arena;
+CJSON_PUBLIC(cJSON_Arena *) cJSON_ArenaCreate(size_t chunk_size);
+CJSON_PUBLIC(cJSON *) cJSON_ArenaParse(cJSON_Arena *arena, const char *value);
+CJSON_PUBLIC(cJSON *) cJSON_ArenaParseWithLength(cJSON_Arena *arena, const char *value, size_t buffer_length);
+CJSON_PUBLIC(char *) cJSON_ArenaPrint(cJSON_Arena *arena, const cJSON *item);
+CJSON_PUBLIC(char *) cJSON_ArenaPrintUnformatted(cJSON_Arena *arena, const cJSON *item);
+CJSON_PUBLIC(cJSON *) cJSON_ArenaDuplicate(cJSON_Arena *arena, const cJSON *item, cJSON_bool recurse);
+/* Releases everything allocated from the arena, keeping one chunk for reuse. */
+CJSON_PUBLIC(void) cJSON_ArenaReset(cJSON_Arena *arena);
+CJSON_PUBLIC(void) cJSON_ArenaDelete(cJSON_Arena *arena);
+
+/* Streaming: feed a document in chunks of any size and get one callback per token instead of a tree.
+ * Only the bytes of an unfinished token are held between chunks. Strings are only valid during their
+ * callback. Any callback may be NULL, returning false from one stops the parse. Like cJSON_Parse, what
+ * follows the document is ignored. */
+typedef struct cJSON_SaxHandler
+{
+    cJSON_bool (*start_object)(void *user);
+    cJSON_bool (*end_object)(void *user);
+    cJSON_bool (*start_array)(void *user);
+    cJSON_bool (*end_array)(void *user);
+    cJSON_bool (*key)(void *user, const char *key);
+    cJSON_bool (*string)(void *user, const char *value);
+    cJSON_bool (*number)(void *user, double value);
+    cJSON_bool (*boolean)(void *user, cJSON_bool value);
+    cJSON_bool (*null)(void *user);
+} cJSON_SaxHandler;
+
+typedef struct cJSON_Sax cJSON_Sax;
+CJSON_PUBLIC(cJSON_Sax *) cJSON_SaxCreate(const cJSON_SaxHandler *handler, void *user);
+/* Returns false on invalid JSON, a failed allocation or a callback that returned false. */
+CJSON_PUBLIC(cJSON_bool) cJSON_SaxFeed(cJSON_Sax *sax, const char *chunk, size_t length);
+/* End of input, returns true if a whole document was parsed. */
+CJSON_PUBLIC(cJSON_bool) cJSON_SaxFinish(cJSON_Sax *sax);
+/* Bytes consumed so far, where the error is after a failure. */
+CJSON_PUBLIC(size_t) cJSON_SaxOffset(const cJSON_Sax *sax);
+CJSON_PUBLIC(void) cJSON_SaxDelete(cJSON_Sax *sax);
+
 #ifdef __cplusplus
 }
 #endif
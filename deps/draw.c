@@ -2,10 +2,9 @@
 #include "includes.h"
 #include "objects.h"
 
-void drawMenu(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
+void drawMenu(SDL_Renderer *gRenderer, FontCache *fontCache,
               Button *buttons, float f1PosX, float f2PosX,
-              SDL_Texture *menuBack1, SDL_Texture *menuBack2,
-              TTF_Font *kenVectorFont) {
+              SDL_Texture *menuBack1, SDL_Texture *menuBack2) {
   char buttonsText[3][10] = {"Play", "Scores", "Quit"};
   SDL_SetRenderDrawColor(gRenderer, 0x06, 0x12, 0x21, 0xFF);
   SDL_RenderClear(gRenderer);
@@ -22,8 +21,7 @@ void drawMenu(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
 
   for (uint8 i = 0; i < 3; i++) // Number of Buttons
   {
-    TTF_Text *buttonText = TTF_CreateText(
-        gTextEngine, kenVectorFont, buttonsText[i], strlen(buttonsText[i]));
+    TTF_Text *buttonText = fontText(fontCache, SMALLFONT, buttonsText[i]);
     int textHeight, textWidth;
     TTF_GetTextSize(buttonText, &textWidth, &textHeight);
     if (buttons[i].hovered) {
@@ -43,11 +41,10 @@ void drawMenu(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
   SDL_RenderPresent(gRenderer);
 }
 
-void drawGame(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
+void drawGame(SDL_Renderer *gRenderer, FontCache *fontCache,
               Player *player, AsteroidNode *asteroids, PowerUpNode *powerUps,
               TTF_Text *fpsText, SDL_Texture *gameBack,
-              SDL_Texture *spriteSheet, Sprite *spriteList,
-              TTF_Font *kenVectorFont) {
+              SpriteRegistry *sprites) {
   SDL_SetRenderDrawColor(gRenderer, 0x22, 0x22, 0x11, 0xFF);
   SDL_RenderClear(gRenderer);
 
@@ -63,12 +60,14 @@ void drawGame(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
 
   SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
 
-  SDL_FRect bulletSpriteRect = getSpriteRect(spriteList, "laserRed16.png");
+  int bulletSprite = spriteFind(sprites, "laserRed16.png");
+  SDL_FRect bulletSpriteRect = spriteRect(sprites, bulletSprite);
+  SDL_Texture *bulletTexture = spriteTexture(sprites, bulletSprite);
   BulletNode *bullPtr = &player->bullets;
   while (bullPtr != NULL) {
     if (!SDL_HasRectIntersectionFloat(&player->rect, &bullPtr->bullet.rect) &&
         bullPtr->bullet.damage != -1) {
-      SDL_RenderTextureRotated(gRenderer, spriteSheet, &bulletSpriteRect,
+      SDL_RenderTextureRotated(gRenderer, bulletTexture, &bulletSpriteRect,
                                &bullPtr->bullet.rect, bullPtr->bullet.rot, NULL,
                                SDL_FLIP_NONE);
       // SDL_RenderRect(gRenderer, &bullPtr->bullet.rect);
@@ -81,39 +80,40 @@ void drawGame(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
   while (astPtr != NULL) /* Render Asteroids */
   {
     SDL_RenderTextureRotated(
-        gRenderer, spriteSheet, &astPtr->asteroid.spriteRect,
-        &astPtr->asteroid.rect, astPtr->asteroid.rot, NULL, SDL_FLIP_NONE);
+        gRenderer, spriteTexture(sprites, astPtr->asteroid.sprite),
+        &astPtr->asteroid.spriteRect, &astPtr->asteroid.rect,
+        astPtr->asteroid.rot, NULL, SDL_FLIP_NONE);
     astPtr = astPtr->nextAsteroid;
   }
 
   PowerUpNode *powerPtr = powerUps;
   while (powerPtr != NULL) {
-    SDL_FRect spriteRect;
+    int powerSprite = -1;
     if (powerPtr->power.powerUp == SHIELD) {
-      spriteRect = getSpriteRect(spriteList, "powerupBlue_shield.png");
+      powerSprite = spriteFind(sprites, "powerupBlue_shield.png");
     } else if (powerPtr->power.powerUp == ARMOR) {
-      spriteRect = getSpriteRect(spriteList, "powerupBlue_star.png");
+      powerSprite = spriteFind(sprites, "powerupBlue_star.png");
     } else if (powerPtr->power.powerUp == MULTIBULLET) {
-      spriteRect = getSpriteRect(spriteList, "powerupBlue_bolt.png");
+      powerSprite = spriteFind(sprites, "powerupBlue_bolt.png");
     }
 
-    SDL_RenderTexture(gRenderer, spriteSheet, &spriteRect,
-                      &powerPtr->power.rect);
+    SDL_FRect powerSpriteRect = spriteRect(sprites, powerSprite);
+    SDL_RenderTexture(gRenderer, spriteTexture(sprites, powerSprite),
+                      &powerSpriteRect, &powerPtr->power.rect);
 
     powerPtr = powerPtr->nextPowerUp;
   }
 
   TTF_DrawRendererText(fpsText, WIDTH - 70, HEIGHT - 20);
 
-  playerTextHandler(player, gTextEngine, kenVectorFont);
-  playerRender(player, gRenderer, spriteSheet, spriteList);
+  playerTextHandler(player, fontCache);
+  playerRender(player, gRenderer, sprites);
 
   SDL_RenderPresent(gRenderer);
 }
 
-void drawPaused(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
-                Button *buttons, SDL_Texture *pauseBack,
-                TTF_Font *kenVectorFont) {
+void drawPaused(SDL_Renderer *gRenderer, FontCache *fontCache,
+                Button *buttons, SDL_Texture *pauseBack) {
   char buttonsText[2][10] = {"Resume", "Menu"};
   SDL_SetRenderDrawColor(gRenderer, 0x22, 0x22, 0x11, 0x77);
   SDL_RenderFillRect(gRenderer, NULL);
@@ -130,8 +130,7 @@ void drawPaused(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
 
   for (uint8 i = 0; i < 2; i++) // Number of Buttons
   {
-    TTF_Text *buttonText = TTF_CreateText(
-        gTextEngine, kenVectorFont, buttonsText[i], strlen(buttonsText[i]));
+    TTF_Text *buttonText = fontText(fontCache, SMALLFONT, buttonsText[i]);
     int textHeight, textWidth;
     TTF_GetTextSize(buttonText, &textWidth, &textHeight);
     if (buttons[i].hovered) {
@@ -151,9 +150,8 @@ void drawPaused(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
   SDL_RenderPresent(gRenderer);
 }
 
-void drawOver(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
-              Button *buttons, TTF_Text **texts, SDL_Texture *overBack,
-              TTF_Font *kenVectorFont) {
+void drawOver(SDL_Renderer *gRenderer, FontCache *fontCache,
+              Button *buttons, TTF_Text **texts, SDL_Texture *overBack) {
   SDL_SetRenderDrawColor(gRenderer, 0x22, 0x22, 0x11, 0xFF);
   SDL_RenderClear(gRenderer);
 
@@ -175,17 +173,14 @@ void drawOver(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
   TTF_GetTextSize(texts[1], &textWidth, &textHeight);
   TTF_DrawRendererText(texts[1], WIDTH / 2.f - textWidth / 2.f,
                        3 * HEIGHT / 4.f - textHeight / 2.f);
-  TTF_SetFontSize(kenVectorFont, HEIGHT / 50.f);
   TTF_GetTextSize(texts[2], &textWidth, &textHeight);
   TTF_DrawRendererText(texts[2], WIDTH / 2.f - textWidth / 2.f,
                        7 * HEIGHT / 8.f - textHeight / 2.f);
-  TTF_SetFontSize(kenVectorFont, 3 * HEIGHT / 50.f);
 
   char buttonsText[2][10] = {"Menu", "Replay"};
   for (uint8 i = 0; i < 2; i++) // Number of Buttons
   {
-    TTF_Text *buttonText = TTF_CreateText(
-        gTextEngine, kenVectorFont, buttonsText[i], strlen(buttonsText[i]));
+    TTF_Text *buttonText = fontText(fontCache, LARGEFONT, buttonsText[i]);
     TTF_GetTextSize(buttonText, &textWidth, &textHeight);
     if (buttons[i].hovered) {
       SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
@@ -204,9 +199,30 @@ void drawOver(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
   SDL_RenderPresent(gRenderer);
 }
 
-void drawScores(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
-                Button *buttons, TTF_Text **texts, ScoreObj *scores,
-                SDL_Texture *scoreBack, TTF_Font *kenVectorFont) {
+static void drawColumns(TTF_Text **texts, int columnCount,
+                        float y) /* First left, last right, the rest
+                                    centered between */
+{
+  int textWidth, textHeight;
+  for (int i = 0; i < columnCount; i++) {
+    TTF_GetTextSize(texts[i], &textWidth, &textHeight);
+
+    float x;
+    if (i == 0)
+      x = 10;
+    else if (i == columnCount - 1)
+      x = WIDTH - (10 + textWidth);
+    else if (columnCount == 3)
+      x = WIDTH / 2.f - textWidth / 2.f;
+    else
+      x = WIDTH * (0.4f + 0.18f * (i - 1)) - textWidth / 2.f;
+    TTF_DrawRendererText(texts[i], x, y - textHeight / 2.f);
+  }
+}
+
+void drawScores(SDL_Renderer *gRenderer, FontCache *fontCache,
+                Button *buttons, TTF_Text **texts, ScoreView *view,
+                SDL_Texture *scoreBack) {
   SDL_SetRenderDrawColor(gRenderer, 0x22, 0x22, 0x11, 0xFF);
   SDL_RenderClear(gRenderer);
 
@@ -221,19 +237,17 @@ void drawScores(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
     }
 
   SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
-  if (texts[3] != NULL) {
+  if (texts[3] != NULL) /* Typing -> Prompt and name over the live results */
+  {
     int textHeight, textWidth;
-    TTF_SetFontSize(kenVectorFont, HEIGHT / 50.f);
     TTF_GetTextSize(texts[0], &textWidth, &textHeight);
     TTF_DrawRendererText(texts[0], WIDTH / 2.f - textWidth / 2.f,
-                         3 * HEIGHT / 4.f - textHeight / 2.f);
-    TTF_SetFontSize(kenVectorFont, 3 * HEIGHT / 50.f);
+                         50 - textHeight / 2.f);
     TTF_GetTextSize(texts[1], &textWidth, &textHeight);
     TTF_DrawRendererText(texts[1], WIDTH / 2.f - textWidth / 2.f,
-                         2 * HEIGHT / 4.f - textHeight / 2.f);
+                         1 * HEIGHT / 11.f - textHeight / 2.f);
   } else {
-    TTF_SetFontSize(kenVectorFont, HEIGHT / 50.f);
-    for (uint8 i = 0; i < 2; i++) // Number of Buttons
+    for (uint8 i = 0; i < 3; i++) // Number of Buttons
     {
       int textHeight, textWidth;
       TTF_GetTextSize(buttons[i].text, &textWidth, &textHeight);
@@ -256,47 +270,28 @@ void drawScores(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine,
     TTF_GetTextSize(texts[2], &textWidth, &textHeight);
     TTF_DrawRendererText(texts[2], WIDTH / 2.f - textWidth / 2.f,
                          50 - textHeight / 2.f);
-    TTF_SetFontSize(kenVectorFont, 3 * HEIGHT / 50.f);
-
-    char *tempStr;
-    TTF_Text *tempText = NULL;
-
-    SDL_asprintf(&tempStr, "Username");
-    tempText = TTF_CreateText(gTextEngine, kenVectorFont, tempStr, 0);
-    TTF_GetTextSize(tempText, &textWidth, &textHeight);
-    TTF_DrawRendererText(tempText, 10,
-                         (2 * HEIGHT / 11.f) - (textHeight / 2.f));
-    SDL_asprintf(&tempStr, "Asteroids Destroyed");
-    tempText = TTF_CreateText(gTextEngine, kenVectorFont, tempStr, 0);
-    TTF_GetTextSize(tempText, &textWidth, &textHeight);
-    TTF_DrawRendererText(tempText, WIDTH / 2.f - textWidth / 2.f,
-                         (2 * HEIGHT / 11.f) - (textHeight / 2.f));
-    SDL_asprintf(&tempStr, "Time Survived");
-    tempText = TTF_CreateText(gTextEngine, kenVectorFont, tempStr, 0);
-    TTF_GetTextSize(tempText, &textWidth, &textHeight);
-    TTF_DrawRendererText(tempText, WIDTH - (10 + textWidth),
-                         (2 * HEIGHT / 11.f) - (textHeight / 2.f));
-
-    for (int i = 0; i < 8; i++) {
-      if (scores[i].username[0] != '\0') {
-        SDL_asprintf(&tempStr, "%s", scores[i].username);
-        tempText = TTF_CreateText(gTextEngine, kenVectorFont, tempStr, 0);
-        TTF_GetTextSize(tempText, &textWidth, &textHeight);
-        TTF_DrawRendererText(tempText, 10,
-                             ((i + 3) * HEIGHT / 11.f) - (textHeight / 2.f));
-        SDL_asprintf(&tempStr, "%i", scores[i].score);
-        tempText = TTF_CreateText(gTextEngine, kenVectorFont, tempStr, 0);
-        TTF_GetTextSize(tempText, &textWidth, &textHeight);
-        TTF_DrawRendererText(tempText, WIDTH / 2.f - textWidth / 2.f,
-                             ((i + 3) * HEIGHT / 11.f) - (textHeight / 2.f));
-        SDL_asprintf(&tempStr, "%i", scores[i].time);
-        tempText = TTF_CreateText(gTextEngine, kenVectorFont, tempStr, 0);
-        TTF_GetTextSize(tempText, &textWidth, &textHeight);
-        TTF_DrawRendererText(tempText, WIDTH - (10 + textWidth),
-                             ((i + 3) * HEIGHT / 11.f) - (textHeight / 2.f));
-      }
-    }
   }
 
+  const char *headers[2][VIEW_COLUMNS] = {
+      {"Username", "Asteroids Destroyed", "Time Survived"},
+      {"Player", "Best", "Asteroids", "Time", "Games"}};
+  TTF_Text *headerTexts[VIEW_COLUMNS];
+  for (int i = 0; i < view->columns; i++)
+    headerTexts[i] = fontText(fontCache, LARGEFONT, headers[view->players][i]);
+  drawColumns(headerTexts, view->columns, 2 * HEIGHT / 11.f);
+
+  /* Rows slide with the view, clipped to the table under the header */
+  SDL_Rect table = {0, 2.5f * HEIGHT / 11.f, WIDTH, VIEW_ROWS * HEIGHT / 11.f};
+  SDL_SetRenderClipRect(gRenderer, &table);
+  Uint32 top = (Uint32)view->position;
+  float offset = view->position - top;
+  for (int i = 0; i <= VIEW_ROWS; i++) {
+    const ViewRow *row = scoreViewRow(view, top + i);
+    if (row != NULL)
+      drawColumns((TTF_Text **)row->texts, view->columns,
+                  (i + 3 - offset) * HEIGHT / 11.f);
+  }
+  SDL_SetRenderClipRect(gRenderer, NULL);
+
   SDL_RenderPresent(gRenderer);
 }
@@ -7,11 +7,13 @@
 #include "asteroid.h"
 #include "powerup.h"
 #include "score.h"
+#include "font.h"
+#include "scoreview.h"
 
-void drawMenu(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine, Button *buttons, float f1PosX, float f2PosX, SDL_Texture *menuBack1, SDL_Texture *menuBack2, TTF_Font *kenVectorFont); 
-void drawGame(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine, Player *player, AsteroidNode *asteroids, PowerUpNode *powerUp, TTF_Text *fpsText, SDL_Texture *gameBack, SDL_Texture *spriteSheet, Sprite *spriteList, TTF_Font *kenVectorFont);
-void drawPaused(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine, Button *buttons, SDL_Texture *pauseBack, TTF_Font *kenVectorFont); 
-void drawOver(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine, Button *buttons, TTF_Text **texts, SDL_Texture *overBack, TTF_Font *kenVectorFont); 
-void drawScores(SDL_Renderer *gRenderer, TTF_TextEngine *gTextEngine, Button *buttons, TTF_Text **texts, ScoreObj *scores, SDL_Texture *scoreBack, TTF_Font *kenVectorFont); 
+void drawMenu(SDL_Renderer *gRenderer, FontCache *fontCache, Button *buttons, float f1PosX, float f2PosX, SDL_Texture *menuBack1, SDL_Texture *menuBack2); 
+void drawGame(SDL_Renderer *gRenderer, FontCache *fontCache, Player *player, AsteroidNode *asteroids, PowerUpNode *powerUp, TTF_Text *fpsText, SDL_Texture *gameBack, SpriteRegistry *sprites);
+void drawPaused(SDL_Renderer *gRenderer, FontCache *fontCache, Button *buttons, SDL_Texture *pauseBack); 
+void drawOver(SDL_Renderer *gRenderer, FontCache *fontCache, Button *buttons, TTF_Text **texts, SDL_Texture *overBack); 
+void drawScores(SDL_Renderer *gRenderer, FontCache *fontCache, Button *buttons, TTF_Text **texts, ScoreView *view, SDL_Texture *scoreBack); 
 
 #endif //DRAW_H_
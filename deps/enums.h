@@ -10,5 +10,6 @@ enum Power {
 };
 enum Size { SMALL = 0, NORMAL = 1, LARGE = 2 };
 enum Sort { SCORE = 0, TIME = 1, NAME = 2 };
+enum Font { SMALLFONT = 0, LARGEFONT = 1 };
 
 #endif // ENUMS_H_
@@ -0,0 +1,103 @@
+#include "font.h"
+#include "includes.h"
+#include "objects.h"
+
+static unsigned int fontHash(enum Font font, const char *string) /* FNV-1a */
+{
+  unsigned int hash = 2166136261u ^ font;
+  for (int i = 0; string[i] != '\0'; i++) {
+    hash ^= (unsigned char)string[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+bool fontCacheInit(FontCache *fontCache, TTF_TextEngine *gTextEngine,
+                   const char *fileName) {
+  float sizes[FONTCOUNT] = {HEIGHT / 50.f, 3 * HEIGHT / 50.f};
+
+  memset(fontCache, 0, sizeof(FontCache));
+  fontCache->gTextEngine = gTextEngine;
+
+  for (int i = 0; i < FONTCOUNT; i++) {
+    fontCache->fonts[i] = TTF_OpenFont(fileName, sizes[i]);
+    if (fontCache->fonts[i] == NULL) {
+      printf("'%s' could not be loaded! SDL_ttf Error: %s\n", fileName,
+             SDL_GetError());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+TTF_Text *fontText(FontCache *fontCache, enum Font font,
+                   const char *string) /* Owned by the cache, draw it before
+                                          a few more lookups evict it */
+{
+  unsigned int hash = fontHash(font, string);
+  TextCacheEntry *set =
+      &fontCache->entries[(hash & (TEXTCACHE_SETS - 1)) * TEXTCACHE_WAYS];
+  TextCacheEntry *victim = &set[0];
+
+  fontCache->clock++;
+  for (int i = 0; i < TEXTCACHE_WAYS; i++) {
+    TextCacheEntry *entry = &set[i];
+    if (entry->text != NULL && entry->hash == hash && entry->font == font &&
+        strcmp(entry->string, string) == 0) {
+      fontCache->hits++;
+      entry->lastUsed = fontCache->clock;
+      TTF_SetTextColor(entry->text, 255, 255, 255, 255); /* Buttons recolor */
+      return entry->text;
+    }
+
+    if (victim->text != NULL &&
+        (entry->text == NULL || entry->lastUsed < victim->lastUsed))
+      victim = entry;
+  }
+
+  fontCache->misses++;
+  TTF_Text *text = TTF_CreateText(fontCache->gTextEngine,
+                                  fontCache->fonts[font], string, 0);
+  char *copy = strdup(string);
+  if (text == NULL || copy == NULL) {
+    TTF_DestroyText(text);
+    free(copy);
+    return NULL;
+  }
+
+  if (victim->text != NULL) {
+    TTF_DestroyText(victim->text);
+    free(victim->string);
+  }
+  victim->string = copy;
+  victim->font = font;
+  victim->hash = hash;
+  victim->lastUsed = fontCache->clock;
+  victim->text = text;
+
+  return text;
+}
+
+void fontCachePrint(FontCache *fontCache) {
+  uint64 lookups = fontCache->hits + fontCache->misses;
+  printf("Text cache: %lu hits, %lu misses (%.1f%% hit rate)\n",
+         fontCache->hits, fontCache->misses,
+         lookups ? 100.0 * fontCache->hits / lookups : 0);
+}
+
+void fontCacheDestroy(FontCache *fontCache) /* Before the text engine */
+{
+  for (int i = 0; i < TEXTCACHE_SETS * TEXTCACHE_WAYS; i++) {
+    TTF_DestroyText(fontCache->entries[i].text);
+    free(fontCache->entries[i].string);
+    fontCache->entries[i].text = NULL;
+    fontCache->entries[i].string = NULL;
+  }
+
+  for (int i = 0; i < FONTCOUNT; i++) {
+    TTF_CloseFont(fontCache->fonts[i]);
+    fontCache->fonts[i] = NULL;
+  }
+}
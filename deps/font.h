@@ -0,0 +1,39 @@
+#ifndef FONT_H_
+#define FONT_H_
+
+#include "includes.h"
+
+#define FONT_FILE "Assets/Fonts/kenvector_future_thin.ttf"
+#define FONTCOUNT 2
+#define TEXTCACHE_SETS 128 /* Power of 2 */
+#define TEXTCACHE_WAYS 4
+
+typedef struct TextCacheEntry {
+  char *string;
+  enum Font font;
+  unsigned int hash;
+  uint64 lastUsed;
+  TTF_Text *text;
+} TextCacheEntry;
+
+/* One TTF_Font per size, all drawing through the same text engine so their
+ * glyphs land in its atlas once. Shaped texts are cached by (font, string)
+ * in a 4-way set associative table with LRU replacement per set. */
+typedef struct FontCache {
+  TTF_TextEngine *gTextEngine;
+  TTF_Font *fonts[FONTCOUNT];
+
+  TextCacheEntry entries[TEXTCACHE_SETS * TEXTCACHE_WAYS];
+  uint64 clock;
+
+  uint64 hits;
+  uint64 misses;
+} FontCache;
+
+bool fontCacheInit(FontCache *fontCache, TTF_TextEngine *gTextEngine,
+                   const char *fileName);
+TTF_Text *fontText(FontCache *fontCache, enum Font font, const char *string);
+void fontCachePrint(FontCache *fontCache);
+void fontCacheDestroy(FontCache *fontCache);
+
+#endif // FONT_H_
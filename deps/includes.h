@@ -14,6 +14,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
 
 #define uint8 unsigned char
 #define uint16 unsigned short
@@ -22,6 +30,5 @@
 #define PI 3.14159265359
 #define WIDTH 1280
 #define HEIGHT 720
-#define SPRITEMAX 77
 
 #endif //INCLUDES_H_
@@ -3,25 +3,30 @@
 #include "objects.h"
 
 bool init(SDL_Window **gWindow, SDL_Renderer **gRenderer,
-          TTF_TextEngine **gTextEngine, TTF_Font **kenVectorFont) {
+          TTF_TextEngine **gTextEngine, FontCache *fontCache,
+          Profiler *profiler) {
   printf("=== Start Of Program ===\n");
   bool success = true;
 
   /* Initializing SDL3 */
+  profileMark(profiler, "SDL_Init");
   if (!SDL_Init(SDL_INIT_VIDEO)) {
     printf("SDL could not be initialized! SDL Error: %s\n", SDL_GetError());
     success = false;
   } else {
+    profileMark(profiler, "IMG_Init");
     if (IMG_Init(IMG_INIT_PNG - IMG_INIT_JPG) == 0) {
       printf("SDL_Image could not be initialized! SDL_Image Error %s\n",
              SDL_GetError());
       success = false;
     } else {
+      profileMark(profiler, "TTF_Init");
       if (!TTF_Init()) {
         printf("SDL_ttf could not be initialized! SDL_ttf Error: %s\n",
                SDL_GetError());
         success = false;
       } else {
+        profileMark(profiler, "SDL_CreateWindow");
         *gWindow = SDL_CreateWindow("Astroids-P1", WIDTH, HEIGHT,
                                     SDL_WINDOW_BORDERLESS);
         if (*gWindow == NULL) {
@@ -29,6 +34,7 @@ bool init(SDL_Window **gWindow, SDL_Renderer **gRenderer,
                  SDL_GetError());
           success = false;
         } else {
+          profileMark(profiler, "SDL_CreateRenderer");
           *gRenderer = SDL_CreateRenderer(*gWindow, NULL);
           if (*gRenderer == NULL) {
             printf("Renderer could not be created! SDL Error: %s\n",
@@ -37,25 +43,23 @@ bool init(SDL_Window **gWindow, SDL_Renderer **gRenderer,
           } else {
             SDL_SetRenderVSync(*gRenderer, 1);
             SDL_SetRenderDrawColor(*gRenderer, 0x22, 0x22, 0x11, 0xFF);
+            profileMark(profiler, "TTF_CreateRendererTextEngine");
             *gTextEngine = TTF_CreateRendererTextEngine(*gRenderer);
             if (*gTextEngine == NULL) {
               printf("TextEngine could not be created! SDL_ttf Error: %s\n",
                      SDL_GetError());
               success = false;
             } else {
-              *kenVectorFont = TTF_OpenFont(
-                  "Assets/Fonts/kenvector_future_thin.ttf", HEIGHT / 50.f);
-              if (*kenVectorFont == NULL) {
-                printf("'JetBrainsMono-Medium.ttf' could not be loaded! "
-                       "SDL_ttf Error: %s\n",
-                       SDL_GetError());
+              profileMark(profiler, "TTF_OpenFont");
+              if (!fontCacheInit(fontCache, *gTextEngine, FONT_FILE)) {
                 success = false;
               } else {
+                profileMark(profiler, "Mix_OpenAudio");
                 SDL_AudioSpec audioSpec;
                 SDL_zero(audioSpec);
                 audioSpec.format = MIX_DEFAULT_FORMAT;
-                audioSpec.channels = 2;
-                audioSpec.freq = 44100;
+                audioSpec.channels = SOUND_CHANNELS;
+                audioSpec.freq = SOUND_FREQ;
                 if (Mix_OpenAudio(0, &audioSpec) == 0 ||
                     Mix_Init(MIX_INIT_MP3) == 0 ||
                     Mix_Init(MIX_INIT_OGG) == 0) {
@@ -73,32 +77,38 @@ bool init(SDL_Window **gWindow, SDL_Renderer **gRenderer,
       }
     }
   }
+  profileStop(profiler);
 
   return success;
 }
 
-bool load(SDL_Renderer *gRenderer, Sprite *spriteList, SDL_Texture **menuBack1,
-          SDL_Texture **menuBack2, SDL_Texture **gameBack,
-          SDL_Texture **pauseBack, SDL_Texture **overBack,
-          SDL_Texture **scoreBack, SDL_Texture **spriteSheet,
+static int comparePackNames(const void *a, const void *b) {
+  return SDL_strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+bool load(SDL_Renderer *gRenderer, SpriteRegistry *sprites,
+          SDL_Texture **menuBack1, SDL_Texture **menuBack2,
+          SDL_Texture **gameBack, SDL_Texture **pauseBack,
+          SDL_Texture **overBack, SDL_Texture **scoreBack,
           Mix_Music **bgMusic, Mix_Music **battleMusic, Mix_Chunk **shootSfx,
           Mix_Chunk **shieldUpSfx, Mix_Chunk **shieldDownSfx,
           Mix_Chunk **astDestroySfx, Mix_Chunk **loseSfx,
-          Mix_Chunk **selectSfx) /* Get Game Objects and
-load their respective assets */
+          Mix_Chunk **selectSfx, SoundBank *soundBank,
+          Profiler *profiler) /* Get Game Objects and load their respective
+                                 assets */
 {
   bool success = true;
 
-  *menuBack1 = SDL_CreateTextureFromSurface(
-      gRenderer, IMG_Load("Assets/Backgrounds/menu1.png"));
+  profileMark(profiler, "Assets/Backgrounds/menu1.png");
+  *menuBack1 = textureLoad(gRenderer, "Assets/Backgrounds/menu1.png");
   if (*menuBack1 == NULL) {
     printf("'Assets/Backgrounds/menu1.png' could not be loaded! SDL_image "
            "Error: %s\n",
            SDL_GetError());
     success = false;
   }
-  *menuBack2 = SDL_CreateTextureFromSurface(
-      gRenderer, IMG_Load("Assets/Backgrounds/menu2.png"));
+  profileMark(profiler, "Assets/Backgrounds/menu2.png");
+  *menuBack2 = textureLoad(gRenderer, "Assets/Backgrounds/menu2.png");
   if (*menuBack2 == NULL) {
     printf("'Assets/Backgrounds/menu2.png' could not be loaded! SDL_image "
            "Error: %s\n",
@@ -106,8 +116,8 @@ load their respective assets */
     success = false;
   }
 
-  *scoreBack = SDL_CreateTextureFromSurface(
-      gRenderer, IMG_Load("Assets/Backgrounds/scores.png"));
+  profileMark(profiler, "Assets/Backgrounds/scores.png");
+  *scoreBack = textureLoad(gRenderer, "Assets/Backgrounds/scores.png");
   if (*scoreBack == NULL) {
     printf("'Assets/Backgrounds/scores.png' could not be loaded! SDL_image "
            "Error: %s\n",
@@ -115,8 +125,8 @@ load their respective assets */
     success = false;
   }
 
-  *gameBack = SDL_CreateTextureFromSurface(
-      gRenderer, IMG_Load("Assets/Backgrounds/game.png"));
+  profileMark(profiler, "Assets/Backgrounds/game.png");
+  *gameBack = textureLoad(gRenderer, "Assets/Backgrounds/game.png");
   if (*gameBack == NULL) {
     printf("'Assets/Backgrounds/game.png' could not be loaded! SDL_image "
            "Error: %s\n",
@@ -124,8 +134,8 @@ load their respective assets */
     success = false;
   }
 
-  *pauseBack = SDL_CreateTextureFromSurface(
-      gRenderer, IMG_Load("Assets/Backgrounds/paused.png"));
+  profileMark(profiler, "Assets/Backgrounds/paused.png");
+  *pauseBack = textureLoad(gRenderer, "Assets/Backgrounds/paused.png");
   if (*pauseBack == NULL) {
     printf("'Assets/Backgrounds/paused.png' could not be loaded! SDL_image "
            "Error: %s\n",
@@ -133,8 +143,8 @@ load their respective assets */
     success = false;
   }
 
-  *overBack = SDL_CreateTextureFromSurface(
-      gRenderer, IMG_Load("Assets/Backgrounds/over.png"));
+  profileMark(profiler, "Assets/Backgrounds/over.png");
+  *overBack = textureLoad(gRenderer, "Assets/Backgrounds/over.png");
   if (*overBack == NULL) {
     printf("'Assets/Backgrounds/over.png' could not be loaded! SDL_image "
            "Error: %s\n",
@@ -142,17 +152,27 @@ load their respective assets */
     success = false;
   }
 
-  *spriteSheet =
-      SDL_CreateTextureFromSurface(gRenderer, IMG_Load("Assets/sheet.png"));
-  if (*spriteSheet == NULL) {
-    printf("'Assets/sheet.png' could not be loaded! SDL_image Error: %s\n",
-           SDL_GetError());
+  profileMark(profiler, "Assets/sheet.xml");
+  if (!parseXML("Assets/sheet.xml", sprites, gRenderer))
     success = false;
-  }
 
-  parseXML("Assets/sheet.xml", spriteList);
+  /* Content Packs -> Extra atlases in file name order, later sprites
+   * override by name. A broken pack is skipped, the game runs without it */
+  profileMark(profiler, "Assets/Packs");
+  int packCount = 0;
+  char **packs = SDL_GlobDirectory("Assets/Packs", "*.xml", 0, &packCount);
+  if (packs != NULL)
+    SDL_qsort(packs, packCount, sizeof(char *), comparePackNames);
+  for (int i = 0; i < packCount; i++) {
+    char packPath[256];
+    snprintf(packPath, sizeof(packPath), "Assets/Packs/%s", packs[i]);
+    if (!parseXML(packPath, sprites, gRenderer))
+      printf("Content pack '%s' was skipped.\n", packPath);
+  }
+  SDL_free(packs);
 
   // Sound and Music
+  profileMark(profiler, "Assets/Music/background.mp3");
   *bgMusic = Mix_LoadMUS("Assets/Music/background.mp3");
   if (*bgMusic == NULL) {
     printf("'Assets/Music/background.mp3' could not be loaded! SDL_mixer "
@@ -161,6 +181,7 @@ load their respective assets */
     success = false;
   }
 
+  profileMark(profiler, "Assets/Music/battle.mp3");
   *battleMusic = Mix_LoadMUS("Assets/Music/battle.mp3");
   if (*battleMusic == NULL) {
     printf("'Assets/Music/battle.mp3' could not be loaded! SDL_mixer "
@@ -169,7 +190,11 @@ load their respective assets */
     success = false;
   }
 
-  *selectSfx = Mix_LoadWAV("Assets/SoundEffects/sfx_twoTone.ogg");
+  profileMark(profiler, SOUNDBANK_FILE);
+  soundBankOpen(soundBank, SOUNDBANK_FILE); /* Missing -> Decode each file */
+
+  profileMark(profiler, "Assets/SoundEffects/sfx_twoTone.ogg");
+  *selectSfx = soundLoad(soundBank, "Assets/SoundEffects/sfx_twoTone.ogg");
   if (*selectSfx == NULL) {
     printf(
         "'Assets/SoundEffects/sfx_twoTone.ogg' could not be loaded! SDL_mixer "
@@ -178,7 +203,8 @@ load their respective assets */
     success = false;
   }
 
-  *shootSfx = Mix_LoadWAV("Assets/SoundEffects/sfx_laser2.ogg");
+  profileMark(profiler, "Assets/SoundEffects/sfx_laser2.ogg");
+  *shootSfx = soundLoad(soundBank, "Assets/SoundEffects/sfx_laser2.ogg");
   if (*shootSfx == NULL) {
     printf(
         "'Assets/SoundEffects/sfx_laser2.ogg' could not be loaded! SDL_mixer "
@@ -187,7 +213,8 @@ load their respective assets */
     success = false;
   }
 
-  *shieldUpSfx = Mix_LoadWAV("Assets/SoundEffects/sfx_shieldUp.ogg");
+  profileMark(profiler, "Assets/SoundEffects/sfx_shieldUp.ogg");
+  *shieldUpSfx = soundLoad(soundBank, "Assets/SoundEffects/sfx_shieldUp.ogg");
   if (*shieldUpSfx == NULL) {
     printf(
         "'Assets/SoundEffects/sfx_shieldUp.ogg' could not be loaded! SDL_mixer "
@@ -196,7 +223,9 @@ load their respective assets */
     success = false;
   }
 
-  *shieldDownSfx = Mix_LoadWAV("Assets/SoundEffects/sfx_shieldDown.ogg");
+  profileMark(profiler, "Assets/SoundEffects/sfx_shieldDown.ogg");
+  *shieldDownSfx =
+      soundLoad(soundBank, "Assets/SoundEffects/sfx_shieldDown.ogg");
   if (*shieldDownSfx == NULL) {
     printf("'Assets/SoundEffects/sfx_shieldDown.ogg' could not be loaded! "
            "SDL_mixer "
@@ -205,7 +234,8 @@ load their respective assets */
     success = false;
   }
 
-  *astDestroySfx = Mix_LoadWAV("Assets/SoundEffects/sfx_zap.ogg");
+  profileMark(profiler, "Assets/SoundEffects/sfx_zap.ogg");
+  *astDestroySfx = soundLoad(soundBank, "Assets/SoundEffects/sfx_zap.ogg");
   if (*astDestroySfx == NULL) {
     printf("'Assets/SoundEffects/sfx_zap.ogg' could not be loaded! "
            "SDL_mixer "
@@ -214,7 +244,8 @@ load their respective assets */
     success = false;
   }
 
-  *loseSfx = Mix_LoadWAV("Assets/SoundEffects/sfx_lose.ogg");
+  profileMark(profiler, "Assets/SoundEffects/sfx_lose.ogg");
+  *loseSfx = soundLoad(soundBank, "Assets/SoundEffects/sfx_lose.ogg");
   if (*loseSfx == NULL) {
     printf("'Assets/SoundEffects/sfx_lose.ogg' could not be loaded! "
            "SDL_mixer "
@@ -223,13 +254,14 @@ load their respective assets */
     success = false;
   }
 
+  profileStop(profiler);
+
   return success;
 }
 
 bool loadPlayer(SDL_Renderer *gRenderer, Player *player) {
   bool success = true;
-  player->icon =
-      SDL_CreateTextureFromSurface(gRenderer, IMG_Load("Assets/Crystal.png"));
+  player->icon = textureLoad(gRenderer, "Assets/Crystal.png");
   if (player->icon == NULL) {
     printf("'Crystal.png' could not be loaded! SDL_image Error: %s\n",
            SDL_GetError());
@@ -0,0 +1,1840 @@
+#include "leaderboard.h"
+#include "includes.h"
+#include "objects.h"
+
+typedef struct IndexKey {
+  const ScoreRecord *record;
+  Uint32 id;
+  enum Sort type;
+} IndexKey;
+
+static int compareRecords(const ScoreRecord *recordA,
+                          const ScoreRecord *recordB, enum Sort type) {
+  if (type == SCORE) /* Not a difference, saturated imports overflow it */
+    return (recordB->score > recordA->score) -
+           (recordB->score < recordA->score);
+  else if (type == TIME)
+    return (recordB->time > recordA->time) - (recordB->time < recordA->time);
+  else
+    return strncmp(recordA->username, recordB->username,
+                   sizeof(recordA->username));
+}
+
+static int compareIndexKeys(const void *a, const void *b) /* Ties by ID */
+{
+  const IndexKey *keyA = a;
+  const IndexKey *keyB = b;
+
+  int order = compareRecords(keyA->record, keyB->record, keyA->type);
+  if (order != 0)
+    return order;
+  return (keyA->id > keyB->id) - (keyA->id < keyB->id);
+}
+
+static bool indexBuild(const ScoreRecord *records, Uint32 count,
+                       enum Sort type, Uint32 *order) {
+  IndexKey *keys = malloc((count ? count : 1) * sizeof(IndexKey));
+  if (keys == NULL)
+    return false;
+
+  for (Uint32 i = 0; i < count; i++) {
+    keys[i].record = &records[i];
+    keys[i].id = i;
+    keys[i].type = type;
+  }
+  qsort(keys, count, sizeof(IndexKey), compareIndexKeys);
+
+  for (Uint32 i = 0; i < count; i++)
+    order[i] = keys[i].id;
+  free(keys);
+
+  return true;
+}
+
+static Uint32 journalChecksum(const JournalEntry *entry) /* FNV-1a */
+{
+  const unsigned char *bytes = (const unsigned char *)entry;
+  Uint32 hash = 2166136261u;
+  for (size_t i = 0; i < offsetof(JournalEntry, checksum); i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static bool fileSync(FILE *file) /* On the disk, not just handed to the OS,
+                                     so a power cut can't lose it */
+{
+  if (fflush(file) != 0)
+    return false;
+#ifdef _WIN32
+  return _commit(_fileno(file)) == 0;
+#else
+  return fsync(fileno(file)) == 0;
+#endif
+}
+
+static bool directorySync(const char *fileName) /* Makes a rename in the
+                                                   file's directory durable */
+{
+#ifdef _WIN32
+  (void)fileName; /* NTFS journals the rename itself */
+  return true;
+#else
+  char directory[300];
+  const char *slash = strrchr(fileName, '/');
+  if (slash != NULL)
+    snprintf(directory, sizeof(directory), "%.*s",
+             (int)(slash - fileName + 1), fileName);
+  else
+    snprintf(directory, sizeof(directory), ".");
+
+  int handle = open(directory, O_RDONLY);
+  if (handle < 0)
+    return false;
+  bool success = fsync(handle) == 0;
+  close(handle);
+  return success;
+#endif
+}
+
+static bool fileReplace(const char *tempName,
+                        const char *fileName) /* Rename a synced file over,
+                                                 or clean up */
+{
+  if (SDL_RenamePath(tempName, fileName))
+    return directorySync(fileName);
+
+  remove(tempName);
+  return false;
+}
+
+static bool snapshotWrite(const char *fileName, const ScoreRecord *records,
+                          Uint32 count, Uint32 foldedSeq) {
+  LeaderboardHeader header;
+  header.magic = LEADERBOARD_MAGIC;
+  header.version = LEADERBOARD_VERSION;
+  header.recordSize = sizeof(ScoreRecord);
+  header.count = count;
+  header.foldedSeq = foldedSeq;
+  header.reserved = 0;
+
+  char tempName[300];
+  snprintf(tempName, sizeof(tempName), "%s.tmp", fileName);
+  FILE *snapshot = fopen(tempName, "wb");
+  if (snapshot == NULL)
+    return false;
+
+  bool success = fwrite(&header, sizeof(header), 1, snapshot) == 1 &&
+                 fwrite(records, sizeof(ScoreRecord), count, snapshot) == count &&
+                 fileSync(snapshot);
+  success = fclose(snapshot) == 0 && success;
+
+  if (!success) {
+    remove(tempName);
+    return false;
+  }
+  return fileReplace(tempName, fileName);
+}
+
+static ScoreRecord *snapshotRead(const char *fileName,
+                                 LeaderboardHeader *header,
+                                 Uint32 spare) /* Records land after spare
+                                                  empty slots, caller frees */
+{
+  FILE *snapshot = fopen(fileName, "rb");
+  if (snapshot == NULL) {
+    printf("Unable to open '%s'.\n", fileName);
+    return NULL;
+  }
+
+  if (fread(header, sizeof(LeaderboardHeader), 1, snapshot) != 1 ||
+      header->magic != LEADERBOARD_MAGIC ||
+      header->version != LEADERBOARD_VERSION ||
+      header->recordSize != sizeof(ScoreRecord)) {
+    printf("'%s' is not a leaderboard file.\n", fileName);
+    fclose(snapshot);
+    return NULL;
+  }
+
+  Uint32 capacity = spare + header->count;
+  ScoreRecord *records = malloc((capacity ? capacity : 1) * sizeof(ScoreRecord));
+  if (records != NULL && fread(records + spare, sizeof(ScoreRecord),
+                               header->count, snapshot) != header->count) {
+    printf("'%s' is truncated.\n", fileName);
+    free(records);
+    records = NULL;
+  }
+  fclose(snapshot);
+
+  return records;
+}
+
+static bool fileMap(const char *fileName,
+                    LeaderboardMap *map) /* Read-only view of the whole file */
+{
+  memset(map, 0, sizeof(LeaderboardMap));
+#ifndef _WIN32
+  int file = open(fileName, O_RDONLY);
+  if (file == -1)
+    return false;
+
+  struct stat info;
+  if (fstat(file, &info) == 0 && info.st_size > 0) {
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (data != MAP_FAILED) {
+      map->data = data;
+      map->size = info.st_size;
+      map->mapped = true;
+    }
+  }
+  close(file);
+  if (map->mapped)
+    return true;
+#endif
+
+  /* No mmap -> One read of the whole file */
+  FILE *stream = fopen(fileName, "rb");
+  if (stream == NULL)
+    return false;
+
+  long size = -1;
+  if (fseek(stream, 0, SEEK_END) == 0)
+    size = ftell(stream);
+  rewind(stream);
+  map->data = size >= 0 ? malloc(size ? size : 1) : NULL;
+  bool success =
+      map->data != NULL && fread(map->data, 1, size, stream) == (size_t)size;
+  fclose(stream);
+
+  if (!success) {
+    free(map->data);
+    map->data = NULL;
+    return false;
+  }
+  map->size = size;
+  return true;
+}
+
+static void mapFree(LeaderboardMap *map) {
+#ifndef _WIN32
+  if (map->mapped)
+    munmap(map->data, map->size);
+  else
+#endif
+    free(map->data);
+  memset(map, 0, sizeof(LeaderboardMap));
+}
+
+static const ScoreRecord *snapshotMapRead(
+    const char *fileName, LeaderboardMap *map,
+    LeaderboardHeader *header) /* Records in place, valid until mapFree */
+{
+  if (!fileMap(fileName, map)) {
+    printf("Unable to open '%s'.\n", fileName);
+    return NULL;
+  }
+
+  const LeaderboardHeader *mapped = map->data;
+  if (map->size < sizeof(LeaderboardHeader) ||
+      mapped->magic != LEADERBOARD_MAGIC ||
+      mapped->version != LEADERBOARD_VERSION ||
+      mapped->recordSize != sizeof(ScoreRecord)) {
+    printf("'%s' is not a leaderboard file.\n", fileName);
+    mapFree(map);
+    return NULL;
+  }
+  if ((map->size - sizeof(LeaderboardHeader)) / sizeof(ScoreRecord) <
+      mapped->count) {
+    printf("'%s' is truncated.\n", fileName);
+    mapFree(map);
+    return NULL;
+  }
+
+  *header = *mapped;
+  return (const ScoreRecord *)(mapped + 1);
+}
+
+static bool indexMapRead(Leaderboard *leaderboard, const char *indexName,
+                         Uint32 count,
+                         Uint32 foldedSeq) /* Only if it matches the
+                                              snapshot */
+{
+  LeaderboardMap *map = &leaderboard->indexMap;
+  if (!fileMap(indexName, map))
+    return false;
+
+  const IndexHeader *header = map->data;
+  size_t ordersEnd = sizeof(IndexHeader) + 2 * (size_t)count * sizeof(Uint32);
+  if (map->size < ordersEnd || header->magic != INDEX_MAGIC ||
+      header->version != INDEX_VERSION || header->count != count ||
+      header->foldedSeq != foldedSeq) {
+    mapFree(map);
+    return false;
+  }
+
+  const Uint32 *orders = (const Uint32 *)(header + 1);
+  leaderboard->orders[SCORE] = NULL;
+  leaderboard->orders[TIME] = orders;
+  leaderboard->orders[NAME] = orders + count;
+
+  /* Orders alone are still worth using, stats get recomputed */
+  if ((map->size - ordersEnd) / sizeof(PlayerStats) >= header->playerCount &&
+      header->playerCount > 0) {
+    leaderboard->savedStats = (const PlayerStats *)(orders + 2 * count);
+    leaderboard->savedPlayers = header->playerCount;
+  }
+  return true;
+}
+
+static bool indexWrite(const char *indexName, const Uint32 *const *orders,
+                       Uint32 count, Uint32 foldedSeq,
+                       const NameIndex *names) {
+  IndexHeader header;
+  header.magic = INDEX_MAGIC;
+  header.version = INDEX_VERSION;
+  header.count = count;
+  header.foldedSeq = foldedSeq;
+  header.playerCount = names->nameCount;
+  header.reserved = 0;
+
+  char tempName[300];
+  snprintf(tempName, sizeof(tempName), "%s.tmp", indexName);
+  FILE *index = fopen(tempName, "wb");
+  if (index == NULL)
+    return false;
+
+  bool success = fwrite(&header, sizeof(header), 1, index) == 1 &&
+                 fwrite(orders[TIME], sizeof(Uint32), count, index) == count &&
+                 fwrite(orders[NAME], sizeof(Uint32), count, index) == count;
+  for (Uint32 i = 0; success && i < names->nameCount; i++)
+    success = fwrite(&names->names[i].stats, sizeof(PlayerStats), 1, index) == 1;
+  success = success && fileSync(index);
+  success = fclose(index) == 0 && success;
+
+  if (!success) {
+    remove(tempName);
+    return false;
+  }
+  return fileReplace(tempName, indexName);
+}
+
+static Uint32 *ordersBuild(const ScoreRecord *records, Uint32 count,
+                           const Uint32 **orders) /* Records must be in score
+                                                     order, returns the time
+                                                     and name orders' buffer */
+{
+  Uint32 *buffer = malloc((count ? count : 1) * 2 * sizeof(Uint32));
+  if (buffer == NULL || !indexBuild(records, count, TIME, buffer) ||
+      !indexBuild(records, count, NAME, buffer + count)) {
+    free(buffer);
+    return NULL;
+  }
+
+  orders[SCORE] = NULL;
+  orders[TIME] = buffer;
+  orders[NAME] = buffer + count;
+  return buffer;
+}
+
+static unsigned int nameHash(const char *name) /* FNV-1a */
+{
+  unsigned int hash = 2166136261u;
+  for (int i = 0; i < USERNAME_MAX && name[i] != '\0'; i++) {
+    hash ^= (unsigned char)name[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static Uint32 nameSlot(NameIndex *names, const char *name,
+                       unsigned int hash) /* Slot holding the name, or the
+                                             empty slot it would go in */
+{
+  Uint32 mask = names->slotCount - 1;
+  Uint32 slot = hash & mask;
+
+  while (names->slots[slot] != -1 &&
+         (names->names[names->slots[slot]].hash != hash ||
+          strncmp(names->names[names->slots[slot]].name, name,
+                  USERNAME_MAX) != 0))
+    slot = (slot + 1) & mask; /* Linear probing */
+
+  return slot;
+}
+
+static bool nameRehash(NameIndex *names, Uint32 slotCount) {
+  int *slots = malloc(slotCount * sizeof(int));
+  if (slots == NULL)
+    return false;
+
+  free(names->slots);
+  names->slots = slots;
+  names->slotCount = slotCount;
+  for (Uint32 i = 0; i < slotCount; i++)
+    names->slots[i] = -1;
+
+  for (Uint32 i = 0; i < names->nameCount; i++)
+    names->slots[nameSlot(names, names->names[i].name, names->names[i].hash)] =
+        i;
+
+  return true;
+}
+
+static NameEntry *nameIntern(NameIndex *names, const char *name,
+                             bool *created) /* Existing entry or a new,
+                                               empty one */
+{
+  unsigned int hash = nameHash(name);
+  *created = false;
+  if (names->slotCount > 0) {
+    int found = names->slots[nameSlot(names, name, hash)];
+    if (found != -1)
+      return &names->names[found];
+  }
+
+  /* Keep the table at most half full */
+  if ((names->nameCount + 1) * 2 > names->slotCount &&
+      !nameRehash(names, names->slotCount ? names->slotCount * 2 : 256))
+    return NULL;
+
+  if (names->nameCount == names->nameCapacity) {
+    Uint32 capacity = names->nameCapacity ? names->nameCapacity * 2 : 64;
+    NameEntry *grown = realloc(names->names, capacity * sizeof(NameEntry));
+    if (grown == NULL)
+      return NULL;
+    names->names = grown;
+
+    Uint32 *sorted = realloc(names->sorted, capacity * sizeof(Uint32));
+    if (sorted == NULL)
+      return NULL;
+    names->sorted = sorted;
+    Uint32 *rank = realloc(names->rank, capacity * sizeof(Uint32));
+    if (rank == NULL)
+      return NULL;
+    names->rank = rank;
+    for (int type = 0; type < NAME; type++) {
+      Uint32 *players = realloc(names->players[type], capacity * sizeof(Uint32));
+      Uint32 *playerRank =
+          players != NULL
+              ? realloc(names->playerRank[type], capacity * sizeof(Uint32))
+              : NULL;
+      if (players != NULL)
+        names->players[type] = players;
+      if (playerRank == NULL)
+        return NULL;
+      names->playerRank[type] = playerRank;
+    }
+
+    names->nameCapacity = capacity;
+  }
+
+  NameEntry *entry = &names->names[names->nameCount];
+  memset(entry, 0, sizeof(NameEntry));
+  entry->name = malloc(USERNAME_MAX);
+  entry->folded = malloc(USERNAME_MAX);
+  entry->hash = hash;
+  if (entry->name == NULL || entry->folded == NULL) {
+    free(entry->name);
+    free(entry->folded);
+    return NULL;
+  }
+  snprintf(entry->name, USERNAME_MAX, "%.*s", USERNAME_MAX - 1, name);
+  for (int i = 0; i < USERNAME_MAX; i++)
+    entry->folded[i] = SDL_tolower((unsigned char)entry->name[i]);
+
+  names->slots[nameSlot(names, name, hash)] = names->nameCount++;
+  *created = true;
+  return entry;
+}
+
+static bool nameReserve(NameEntry *entry, Uint32 capacity) {
+  for (int type = 0; type < SORTCOUNT; type++) {
+    Uint32 *ids = realloc(entry->ids[type], capacity * sizeof(Uint32));
+    if (ids == NULL)
+      return false;
+    entry->ids[type] = ids;
+  }
+
+  entry->capacity = capacity;
+  return true;
+}
+
+static int compareNameKeys(const void *a, const void *b) /* Folded, ties by
+                                                            exact name */
+{
+  const NameEntry *entryA = *(const NameEntry **)a;
+  const NameEntry *entryB = *(const NameEntry **)b;
+
+  int order = strncmp(entryA->folded, entryB->folded, USERNAME_MAX);
+  if (order != 0)
+    return order;
+  return strncmp(entryA->name, entryB->name, USERNAME_MAX);
+}
+
+static void nameSortInsert(NameIndex *names,
+                           Uint32 index) /* A new name, the rest sorted */
+{
+  const NameEntry *entry = &names->names[index];
+  Uint32 low = 0, high = index;
+  while (low < high) {
+    Uint32 mid = low + (high - low) / 2;
+    const NameEntry *other = &names->names[names->sorted[mid]];
+    if (compareNameKeys(&entry, &other) < 0)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+
+  memmove(&names->sorted[low + 1], &names->sorted[low],
+          (index - low) * sizeof(Uint32));
+  names->sorted[low] = index;
+  for (Uint32 i = low; i <= index; i++)
+    names->rank[names->sorted[i]] = i;
+}
+
+static int comparePlayers(const NameEntry *entryA, const NameEntry *entryB,
+                          enum Sort type) /* Ties by name index */
+{
+  Sint64 a = type == SCORE ? entryA->stats.best : entryA->stats.totalTime;
+  Sint64 b = type == SCORE ? entryB->stats.best : entryB->stats.totalTime;
+  if (a != b)
+    return a > b ? -1 : 1;
+  if (type == SCORE && entryA->stats.totalScore != entryB->stats.totalScore)
+    return entryA->stats.totalScore > entryB->stats.totalScore ? -1 : 1;
+  return (entryA > entryB) - (entryA < entryB);
+}
+
+static int compareBestKeys(const void *a, const void *b) {
+  return comparePlayers(*(const NameEntry **)a, *(const NameEntry **)b, SCORE);
+}
+
+static int compareTotalTimeKeys(const void *a, const void *b) {
+  return comparePlayers(*(const NameEntry **)a, *(const NameEntry **)b, TIME);
+}
+
+static void playerRaise(NameIndex *names,
+                        Uint32 index) /* Stats only grow, so after an insert
+                                         a player only moves up */
+{
+  const NameEntry *entry = &names->names[index];
+  for (int type = 0; type < NAME; type++) {
+    Uint32 *players = names->players[type];
+    Uint32 from = names->playerRank[type][index];
+    Uint32 low = 0, high = from;
+    while (low < high) {
+      Uint32 mid = low + (high - low) / 2;
+      if (comparePlayers(entry, &names->names[players[mid]], type) < 0)
+        high = mid;
+      else
+        low = mid + 1;
+    }
+
+    memmove(&players[low + 1], &players[low], (from - low) * sizeof(Uint32));
+    players[low] = index;
+    for (Uint32 i = low; i <= from; i++)
+      names->playerRank[type][players[i]] = i;
+  }
+}
+
+static void nameIndexFree(NameIndex *names) {
+  for (Uint32 i = 0; i < names->nameCount; i++) {
+    free(names->names[i].name);
+    free(names->names[i].folded);
+    for (int type = 0; type < SORTCOUNT; type++)
+      free(names->names[i].ids[type]);
+  }
+
+  free(names->names);
+  free(names->slots);
+  free(names->sorted);
+  free(names->rank);
+  free(names->recordNames);
+  for (int type = 0; type < NAME; type++) {
+    free(names->players[type]);
+    free(names->playerRank[type]);
+  }
+  memset(names, 0, sizeof(NameIndex));
+}
+
+static bool nameIndexBuild(NameIndex *names, const ScoreRecord *records,
+                           const Uint32 *const *orders, Uint32 count,
+                           const PlayerStats *stats,
+                           Uint32 playerCount) /* Walking each order keeps
+                                                  every name's IDs sorted
+                                                  for free. Saved stats are
+                                                  used if they fit */
+{
+  memset(names, 0, sizeof(NameIndex));
+  names->recordNames = malloc((count ? count : 1) * sizeof(Uint32));
+  if (names->recordNames == NULL)
+    return false;
+  names->recordCapacity = count;
+
+  for (Uint32 id = 0; id < count; id++) {
+    bool created;
+    NameEntry *entry = nameIntern(names, records[id].username, &created);
+    if (entry == NULL) {
+      nameIndexFree(names);
+      return false;
+    }
+    entry->capacity++;
+    names->recordNames[id] = entry - names->names;
+  }
+
+  for (Uint32 i = 0; i < names->nameCount; i++) {
+    Uint32 capacity = names->names[i].capacity;
+    if (!nameReserve(&names->names[i], capacity)) {
+      nameIndexFree(names);
+      return false;
+    }
+  }
+
+  for (int type = 0; type < SORTCOUNT; type++) {
+    for (Uint32 i = 0; i < names->nameCount; i++)
+      names->names[i].count = 0;
+
+    for (Uint32 rank = 0; rank < count; rank++) {
+      Uint32 id = orders[type] != NULL ? orders[type][rank] : rank;
+      NameEntry *entry = &names->names[names->recordNames[id]];
+      entry->ids[type][entry->count++] = id;
+    }
+  }
+
+  NameEntry **keys = malloc((names->nameCount ? names->nameCount : 1) *
+                            sizeof(NameEntry *));
+  if (keys == NULL) {
+    nameIndexFree(names);
+    return false;
+  }
+  for (Uint32 i = 0; i < names->nameCount; i++)
+    keys[i] = &names->names[i];
+  qsort(keys, names->nameCount, sizeof(NameEntry *), compareNameKeys);
+  for (Uint32 i = 0; i < names->nameCount; i++) {
+    names->sorted[i] = keys[i] - names->names;
+    names->rank[names->sorted[i]] = i;
+  }
+
+  if (stats != NULL && playerCount == names->nameCount) {
+    for (Uint32 i = 0; i < names->nameCount; i++)
+      names->names[i].stats = stats[i];
+  } else {
+    for (Uint32 id = 0; id < count; id++) {
+      PlayerStats *player = &names->names[names->recordNames[id]].stats;
+      if (player->games++ == 0 || records[id].score > player->best)
+        player->best = records[id].score;
+      player->totalScore += records[id].score;
+      player->totalTime += records[id].time;
+    }
+  }
+
+  for (int type = 0; type < NAME; type++) {
+    qsort(keys, names->nameCount, sizeof(NameEntry *),
+          type == SCORE ? compareBestKeys : compareTotalTimeKeys);
+    for (Uint32 i = 0; i < names->nameCount; i++) {
+      names->players[type][i] = keys[i] - names->names;
+      names->playerRank[type][names->players[type][i]] = i;
+    }
+  }
+  free(keys);
+
+  return true;
+}
+
+bool leaderboardCreate(const char *fileName, const ScoreRecord *records,
+                       Uint32 count) /* New snapshot, records in any order */
+{
+  /* Snapshots are kept in score order */
+  Uint32 *order = malloc((count ? count : 1) * sizeof(Uint32));
+  ScoreRecord *sorted = malloc((count ? count : 1) * sizeof(ScoreRecord));
+  bool success = order != NULL && sorted != NULL &&
+                 indexBuild(records, count, SCORE, order);
+  for (Uint32 i = 0; success && i < count; i++)
+    sorted[i] = records[order[i]];
+
+  success = success && snapshotWrite(fileName, sorted, count, 0);
+  if (!success)
+    printf("Unable to write '%s'.\n", fileName);
+
+  free(order);
+  free(sorted);
+  return success;
+}
+
+typedef struct Migration {
+  ScoreRecord *records;
+  Uint32 count;
+  Uint32 capacity;
+} Migration;
+
+static bool migrationAdd(void *data, const ScoreRecord *record) {
+  Migration *migration = data;
+  if (migration->count == migration->capacity) {
+    Uint32 capacity = migration->capacity ? migration->capacity * 2 : 1024;
+    ScoreRecord *grown =
+        realloc(migration->records, capacity * sizeof(ScoreRecord));
+    if (grown == NULL)
+      return false;
+    migration->records = grown;
+    migration->capacity = capacity;
+  }
+
+  migration->records[migration->count++] = *record;
+  return true;
+}
+
+static bool leaderboardMigrate(const char *fileName,
+                               const char *legacyFile) /* New snapshot, from
+                                                          scores.json if any */
+{
+  Migration migration = {};
+
+  FILE *legacy = legacyFile != NULL && SDL_GetPathInfo(legacyFile, NULL)
+                     ? fopen(legacyFile, "rb")
+                     : NULL;
+  bool migrated = legacy != NULL;
+  if (migrated) {
+    /* Streamed, only the records are held. A file that isn't JSON has no
+     * scores, as when it was parsed whole */
+    if (!streamScores(legacy, legacyFile, migrationAdd, &migration, NULL))
+      migration.count = 0;
+    fclose(legacy);
+  }
+
+  bool success =
+      leaderboardCreate(fileName, migration.records, migration.count);
+  if (success && migrated)
+    printf("Migrated %u scores from '%s'.\n", migration.count, legacyFile);
+
+  free(migration.records);
+  return success;
+}
+
+static const ScoreRecord *recordAt(Leaderboard *leaderboard, Uint32 id) {
+  if (id < leaderboard->snapshotCount)
+    return &leaderboard->snapshot[id];
+  return &leaderboard->tail[id - leaderboard->snapshotCount].record;
+}
+
+static bool recordBefore(Leaderboard *leaderboard, Uint32 idA, Uint32 idB,
+                         enum Sort type) /* Ties by ID */
+{
+  int order = compareRecords(recordAt(leaderboard, idA),
+                             recordAt(leaderboard, idB), type);
+  return order < 0 || (order == 0 && idA < idB);
+}
+
+static void orderInsert(Leaderboard *leaderboard, Uint32 *order, Uint32 count,
+                        Uint32 id, enum Sort type) /* Newest ID, so after
+                                                      every record that
+                                                      doesn't sort behind it */
+{
+  Uint32 low = 0, high = count;
+  while (low < high) {
+    Uint32 mid = low + (high - low) / 2;
+    if (recordBefore(leaderboard, id, order[mid], type))
+      high = mid;
+    else
+      low = mid + 1;
+  }
+
+  memmove(&order[low + 1], &order[low], (count - low) * sizeof(Uint32));
+  order[low] = id;
+}
+
+static bool topBefore(const TopK *top, Uint32 a, Uint32 b,
+                      enum Sort type) /* Ties by ID */
+{
+  int order = compareRecords(&top->records[a], &top->records[b], type);
+  return order < 0 || (order == 0 && top->ids[a] < top->ids[b]);
+}
+
+static void topSwap(TopK *top, Uint32 a, Uint32 b) {
+  ScoreRecord record = top->records[a];
+  Uint32 id = top->ids[a];
+  top->records[a] = top->records[b];
+  top->ids[a] = top->ids[b];
+  top->records[b] = record;
+  top->ids[b] = id;
+}
+
+static void topInsert(TopK *top, const ScoreRecord *record, Uint32 id,
+                      enum Sort type) /* Kept if it beats the weakest */
+{
+  /* Not full -> Append, then up while its parent sorts before it */
+  if (top->count < TOPK_SIZE) {
+    Uint32 at = top->count++;
+    top->records[at] = *record;
+    top->ids[at] = id;
+    while (at > 0 && topBefore(top, (at - 1) / 2, at, type)) {
+      topSwap(top, (at - 1) / 2, at);
+      at = (at - 1) / 2;
+    }
+    return;
+  }
+
+  int order = compareRecords(record, &top->records[0], type);
+  if (order > 0 || (order == 0 && id > top->ids[0]))
+    return;
+
+  /* Replaces the root, then down toward the weaker child */
+  top->records[0] = *record;
+  top->ids[0] = id;
+  for (Uint32 at = 0, child = 1; child < top->count;
+       at = child, child = 2 * at + 1) {
+    if (child + 1 < top->count && topBefore(top, child, child + 1, type))
+      child++;
+    if (!topBefore(top, at, child, type))
+      break;
+    topSwap(top, at, child);
+  }
+}
+
+static void topRebuild(Leaderboard *leaderboard) /* After IDs change */
+{
+  for (int type = 0; type < NAME; type++) {
+    TopK *top = &leaderboard->top[type];
+    top->count = 0;
+    for (Uint32 rank = 0; rank < TOPK_SIZE && rank < leaderboard->count;
+         rank++) {
+      Uint32 id = leaderboardAt(leaderboard, type, rank);
+      topInsert(top, recordAt(leaderboard, id), id, type);
+    }
+  }
+}
+
+static bool namePush(Leaderboard *leaderboard,
+                     Uint32 id) /* Into its name's orders and stats */
+{
+  NameIndex *names = &leaderboard->names;
+  const ScoreRecord *record = recordAt(leaderboard, id);
+  if (id >= names->recordCapacity) {
+    Uint32 capacity = names->recordCapacity ? names->recordCapacity * 2 : 64;
+    Uint32 *recordNames =
+        realloc(names->recordNames, capacity * sizeof(Uint32));
+    if (recordNames == NULL)
+      return false;
+    names->recordNames = recordNames;
+    names->recordCapacity = capacity;
+  }
+
+  bool created;
+  NameEntry *entry = nameIntern(names, record->username, &created);
+  if (entry != NULL && created) {
+    Uint32 index = entry - names->names;
+    nameSortInsert(names, index);
+    for (int type = 0; type < NAME; type++) { /* Raised once it has stats */
+      names->players[type][index] = index;
+      names->playerRank[type][index] = index;
+    }
+  }
+  if (entry == NULL ||
+      (entry->count == entry->capacity &&
+       !nameReserve(entry, entry->capacity ? entry->capacity * 2 : 4)))
+    return false;
+
+  for (int type = 0; type < SORTCOUNT; type++)
+    orderInsert(leaderboard, entry->ids[type], entry->count, id, type);
+  names->recordNames[id] = entry - names->names;
+  entry->count++;
+
+  PlayerStats *player = &entry->stats;
+  if (player->games++ == 0 || record->score > player->best)
+    player->best = record->score;
+  player->totalScore += record->score;
+  player->totalTime += record->time;
+  playerRaise(names, entry - names->names);
+
+  return true;
+}
+
+static bool namesBuild(Leaderboard *leaderboard) /* On first use, most
+                                                    launches never search */
+{
+  if (leaderboard->namesBuilt)
+    return true;
+
+  if (!nameIndexBuild(&leaderboard->names, leaderboard->snapshot,
+                      leaderboard->orders, leaderboard->snapshotCount,
+                      leaderboard->savedStats, leaderboard->savedPlayers))
+    return false;
+  for (Uint32 id = leaderboard->snapshotCount; id < leaderboard->count; id++)
+    if (!namePush(leaderboard, id)) {
+      nameIndexFree(&leaderboard->names);
+      return false;
+    }
+
+  leaderboard->namesBuilt = true;
+  return true;
+}
+
+static bool recordPush(Leaderboard *leaderboard) /* Next tail entry as the
+                                                    next ID, into every
+                                                    order */
+{
+  Uint32 id = leaderboard->count;
+  if (leaderboard->namesBuilt && !namePush(leaderboard, id))
+    return false;
+
+  Uint32 tailCount = id - leaderboard->snapshotCount;
+  for (int type = 0; type < SORTCOUNT; type++)
+    orderInsert(leaderboard, leaderboard->tailOrders[type], tailCount, id,
+                type);
+  for (int type = 0; type < NAME; type++)
+    topInsert(&leaderboard->top[type], recordAt(leaderboard, id), id, type);
+
+  leaderboard->count++;
+  leaderboard->generation++;
+  return true;
+}
+
+static bool journalPush(Leaderboard *leaderboard, const JournalEntry *entry) {
+  if (leaderboard->tailCount == leaderboard->tailCapacity) {
+    Uint32 capacity =
+        leaderboard->tailCapacity ? leaderboard->tailCapacity * 2 : 64;
+    JournalEntry *grown =
+        realloc(leaderboard->tail, capacity * sizeof(JournalEntry));
+    if (grown == NULL)
+      return false;
+    leaderboard->tail = grown;
+
+    for (int type = 0; type < SORTCOUNT; type++) {
+      Uint32 *order =
+          realloc(leaderboard->tailOrders[type], capacity * sizeof(Uint32));
+      if (order == NULL)
+        return false;
+      leaderboard->tailOrders[type] = order;
+    }
+    leaderboard->tailCapacity = capacity;
+  }
+
+  leaderboard->tail[leaderboard->tailCount++] = *entry;
+  if (!recordPush(leaderboard)) {
+    leaderboard->tailCount--;
+    return false;
+  }
+  return true;
+}
+
+static bool journalWrite(JournalWriter *writer, const JournalEntry *entries,
+                         Uint32 count) /* One write and sync per group */
+{
+  if (writer->journal == NULL) /* Lost to a failed rewrite */
+    writer->journal = fopen(writer->journalName, "r+b");
+  if (writer->journal == NULL ||
+      fseek(writer->journal, writer->journalEnd, SEEK_SET) != 0 ||
+      fwrite(entries, sizeof(JournalEntry), count, writer->journal) != count ||
+      !fileSync(writer->journal))
+    return false;
+
+  writer->journalEnd += count * sizeof(JournalEntry);
+  return true;
+}
+
+static void journalDrop(JournalWriter *writer,
+                        Uint32 foldedSeq) /* Rewrite without the entries a
+                                             compaction folded */
+{
+  char tempName[300];
+  snprintf(tempName, sizeof(tempName), "%s.tmp", writer->journalName);
+
+  FILE *journal = fopen(tempName, "wb");
+  bool success = journal != NULL && writer->journal != NULL &&
+                 fseek(writer->journal, 0, SEEK_SET) == 0;
+  long kept = 0;
+  JournalEntry entry;
+  for (long offset = 0; success && offset < writer->journalEnd;
+       offset += sizeof(entry)) {
+    success = fread(&entry, sizeof(entry), 1, writer->journal) == 1;
+    if (success && entry.seq > foldedSeq) {
+      success = fwrite(&entry, sizeof(entry), 1, journal) == 1;
+      kept++;
+    }
+  }
+  success = success && fileSync(journal);
+  if (journal != NULL)
+    success = fclose(journal) == 0 && success;
+
+  /* Failing here is harmless, replay skips what the snapshot has */
+  if (writer->journal != NULL)
+    fclose(writer->journal);
+  if (success && SDL_RenamePath(tempName, writer->journalName)) {
+    writer->journalEnd = kept * sizeof(entry);
+    directorySync(writer->journalName); /* Else the old one, still valid */
+  } else
+    remove(tempName);
+  writer->journal = fopen(writer->journalName, "r+b");
+}
+
+static int journalWriterThread(void *data) {
+  JournalWriter *writer = data;
+  JournalEntry group[JOURNAL_QUEUE_MAX];
+
+  SDL_LockMutex(writer->lock);
+  while (true) {
+    if (writer->queued == 0 && writer->rewriteSeq == 0) {
+      if (writer->stop)
+        break;
+      SDL_WaitCondition(writer->wake, writer->lock);
+      continue;
+    }
+
+    /* Small group -> Let more entries join it for up to JOURNAL_GROUP_MS */
+    Uint64 waited = SDL_GetTicks() - writer->queuedSince;
+    if (writer->queued > 0 && writer->queued < JOURNAL_GROUP_MAX &&
+        !writer->flush && !writer->stop && waited < JOURNAL_GROUP_MS) {
+      SDL_WaitConditionTimeout(writer->wake, writer->lock,
+                               JOURNAL_GROUP_MS - waited);
+      continue;
+    }
+
+    Uint32 count = writer->queued;
+    for (Uint32 i = 0; i < count; i++)
+      group[i] = writer->queue[(writer->head + i) % JOURNAL_QUEUE_MAX];
+    Uint32 rewriteSeq = writer->rewriteSeq;
+    writer->rewriteSeq = 0;
+    SDL_UnlockMutex(writer->lock);
+
+    /* Appends keep queueing while the file is busy */
+    bool success = count == 0 || journalWrite(writer, group, count);
+    if (success && rewriteSeq != 0)
+      journalDrop(writer, rewriteSeq);
+
+    SDL_LockMutex(writer->lock);
+    writer->failed = !success;
+    if (success) {
+      writer->head = (writer->head + count) % JOURNAL_QUEUE_MAX;
+      writer->queued -= count;
+      if (count > 0)
+        writer->writtenSeq = group[count - 1].seq;
+      writer->queuedSince = SDL_GetTicks();
+      writer->flush = writer->flush && writer->queued > 0;
+    } else if (writer->stop) { /* Nothing left to retry with */
+      printf("Unable to save %u scores.\n", writer->queued);
+      writer->queued = 0;
+    } else {
+      printf("Unable to save the score, retrying.\n");
+      writer->rewriteSeq = SDL_max(writer->rewriteSeq, rewriteSeq);
+      SDL_WaitConditionTimeout(writer->wake, writer->lock, JOURNAL_GROUP_MS);
+    }
+    SDL_BroadcastCondition(writer->drained);
+  }
+  SDL_UnlockMutex(writer->lock);
+
+  return 0;
+}
+
+static bool journalWriterStart(JournalWriter *writer) {
+  writer->lock = SDL_CreateMutex();
+  writer->wake = SDL_CreateCondition();
+  writer->drained = SDL_CreateCondition();
+  if (writer->lock == NULL || writer->wake == NULL || writer->drained == NULL)
+    return false;
+
+  writer->thread = SDL_CreateThread(journalWriterThread, "journal", writer);
+  return writer->thread != NULL;
+}
+
+static void journalWriterStop(JournalWriter *writer) /* Drains the queue */
+{
+  if (writer->thread != NULL) {
+    SDL_LockMutex(writer->lock);
+    writer->stop = true;
+    SDL_SignalCondition(writer->wake);
+    SDL_UnlockMutex(writer->lock);
+    SDL_WaitThread(writer->thread, NULL);
+  }
+
+  if (writer->journal != NULL)
+    fclose(writer->journal);
+  if (writer->drained != NULL)
+    SDL_DestroyCondition(writer->drained);
+  if (writer->wake != NULL)
+    SDL_DestroyCondition(writer->wake);
+  if (writer->lock != NULL)
+    SDL_DestroyMutex(writer->lock);
+  memset(writer, 0, sizeof(JournalWriter));
+}
+
+bool leaderboardOpen(Leaderboard *leaderboard, const char *fileName,
+                     const char *journalName, const char *indexName,
+                     const char *legacyFile) {
+  memset(leaderboard, 0, sizeof(Leaderboard));
+  snprintf(leaderboard->fileName, sizeof(leaderboard->fileName), "%s",
+           fileName);
+  snprintf(leaderboard->journalName, sizeof(leaderboard->journalName), "%s",
+           journalName);
+  snprintf(leaderboard->indexName, sizeof(leaderboard->indexName), "%s",
+           indexName);
+  leaderboard->compaction.success = true;
+
+  /* Doesn't Exist -> Create New */
+  if (!SDL_GetPathInfo(fileName, NULL) &&
+      !leaderboardMigrate(fileName, legacyFile))
+    return false;
+
+  /* Mapped, so opening costs nothing per record until one is read */
+  LeaderboardHeader header;
+  leaderboard->snapshot =
+      snapshotMapRead(fileName, &leaderboard->snapshotMap, &header);
+  if (leaderboard->snapshot == NULL)
+    return false;
+  leaderboard->count = header.count;
+  leaderboard->snapshotCount = header.count;
+  leaderboard->foldedSeq = header.foldedSeq;
+  leaderboard->nextSeq = header.foldedSeq + 1;
+
+  /* Saved index -> Used in place, otherwise sort once and save it */
+  if (!indexMapRead(leaderboard, indexName, header.count, header.foldedSeq)) {
+    LeaderboardMap *map = &leaderboard->indexMap;
+    map->data =
+        ordersBuild(leaderboard->snapshot, header.count, leaderboard->orders);
+    map->size = 2 * (size_t)header.count * sizeof(Uint32);
+    if (map->data == NULL || !namesBuild(leaderboard)) { /* For the stats */
+      leaderboardClose(leaderboard);
+      return false;
+    }
+    indexWrite(indexName, leaderboard->orders, header.count, header.foldedSeq,
+               &leaderboard->names);
+  }
+  topRebuild(leaderboard);
+
+  JournalWriter *writer = &leaderboard->writer;
+  snprintf(writer->journalName, sizeof(writer->journalName), "%s",
+           journalName);
+  writer->journal = fopen(journalName, "r+b");
+  if (writer->journal == NULL)
+    writer->journal = fopen(journalName, "w+b");
+  if (writer->journal == NULL) {
+    printf("Unable to open '%s'.\n", journalName);
+    leaderboardClose(leaderboard);
+    return false;
+  }
+
+  /* Replay the tail the snapshot doesn't have yet */
+  JournalEntry entry;
+  while (fread(&entry, sizeof(entry), 1, writer->journal) == 1 &&
+         entry.magic == JOURNAL_MAGIC &&
+         entry.checksum == journalChecksum(&entry)) {
+    writer->journalEnd += sizeof(entry);
+    if (entry.seq <= leaderboard->foldedSeq) /* Compacted before a crash */
+      continue;
+
+    if (!journalPush(leaderboard, &entry)) {
+      leaderboardClose(leaderboard);
+      return false;
+    }
+    leaderboard->nextSeq = entry.seq + 1;
+  }
+  writer->writtenSeq = leaderboard->nextSeq - 1;
+
+  if (!journalWriterStart(writer)) {
+    printf("Unable to start the score writer! SDL Error: %s\n",
+           SDL_GetError());
+    leaderboardClose(leaderboard);
+    return false;
+  }
+
+  return true;
+}
+
+bool leaderboardAppend(Leaderboard *leaderboard,
+                       const ScoreRecord *record) /* Shown at once, written
+                                                     by the worker */
+{
+  JournalEntry entry = {};
+  entry.magic = JOURNAL_MAGIC;
+  entry.seq = leaderboard->nextSeq;
+  entry.record = *record;
+  entry.checksum = journalChecksum(&entry);
+
+  JournalWriter *writer = &leaderboard->writer;
+  if (writer->thread == NULL || !journalPush(leaderboard, &entry)) {
+    printf("Unable to save the score.\n");
+    return false;
+  }
+  leaderboard->nextSeq++;
+
+  /* Full -> Wait for the worker, the only time an append blocks */
+  SDL_LockMutex(writer->lock);
+  while (writer->queued == JOURNAL_QUEUE_MAX)
+    SDL_WaitCondition(writer->drained, writer->lock);
+
+  if (writer->queued == 0)
+    writer->queuedSince = SDL_GetTicks();
+  writer->queue[(writer->head + writer->queued) % JOURNAL_QUEUE_MAX] = entry;
+  writer->queued++;
+  SDL_SignalCondition(writer->wake);
+  SDL_UnlockMutex(writer->lock);
+
+  return true;
+}
+
+bool leaderboardCommit(Leaderboard *leaderboard) /* Waits until every
+                                                    appended score is on
+                                                    disk */
+{
+  JournalWriter *writer = &leaderboard->writer;
+  if (writer->thread == NULL)
+    return false;
+
+  SDL_LockMutex(writer->lock);
+  writer->flush = true;
+  SDL_SignalCondition(writer->wake);
+  while (writer->queued > 0 && !writer->failed)
+    SDL_WaitCondition(writer->drained, writer->lock);
+  bool success = writer->queued == 0;
+  SDL_UnlockMutex(writer->lock);
+
+  return success;
+}
+
+static Uint32 journalCommitted(Leaderboard *leaderboard) /* Entries of tail
+                                                            already written */
+{
+  JournalWriter *writer = &leaderboard->writer;
+
+  SDL_LockMutex(writer->lock);
+  Uint32 queued = leaderboard->nextSeq - 1 - writer->writtenSeq;
+  SDL_UnlockMutex(writer->lock);
+
+  return leaderboard->tailCount - queued;
+}
+
+static bool compactionRun(Compaction *compaction) {
+  LeaderboardHeader header;
+  Uint32 tailCount = compaction->tailCount;
+
+  /* Snapshot goes at the back so the merge can fill from the front */
+  ScoreRecord *records =
+      snapshotRead(compaction->fileName, &header, tailCount);
+  if (records == NULL)
+    return false;
+  Uint32 count = header.count + tailCount;
+
+  ScoreRecord *tail = malloc((tailCount ? tailCount : 1) * sizeof(ScoreRecord));
+  Uint32 *order = malloc((tailCount ? tailCount : 1) * sizeof(Uint32));
+  bool success = tail != NULL && order != NULL;
+  for (Uint32 i = 0; success && i < tailCount; i++)
+    tail[i] = compaction->tail[i].record;
+  success = success && indexBuild(tail, tailCount, SCORE, order);
+
+  /* Both runs are in score order, the snapshot's records are older */
+  Uint32 s = tailCount, t = 0, out = 0;
+  while (success && t < tailCount) {
+    if (s < count &&
+        compareRecords(&records[s], &tail[order[t]], SCORE) <= 0)
+      records[out++] = records[s++];
+    else
+      records[out++] = tail[order[t++]];
+  }
+  free(tail);
+  free(order);
+
+  /* Everything that can fail in memory goes before the files are replaced */
+  compaction->orderBuffer =
+      success ? ordersBuild(records, count, compaction->orders) : NULL;
+  success = compaction->orderBuffer != NULL &&
+            nameIndexBuild(&compaction->names, records, compaction->orders,
+                           count, NULL, 0);
+  if (success &&
+      !snapshotWrite(compaction->fileName, records, count,
+                     compaction->foldedSeq)) {
+    nameIndexFree(&compaction->names);
+    success = false;
+  }
+  if (!success) {
+    free(records);
+    free(compaction->orderBuffer);
+    compaction->orderBuffer = NULL;
+    return false;
+  }
+
+  if (!indexWrite(compaction->indexName, compaction->orders, count,
+                  compaction->foldedSeq, &compaction->names))
+    printf("'%s' could not be written, it will be rebuilt.\n",
+           compaction->indexName);
+
+  compaction->records = records;
+  compaction->count = count;
+  return true;
+}
+
+static int compactionThread(void *data) {
+  Compaction *compaction = data;
+
+  compaction->success = compactionRun(compaction);
+  SDL_SetAtomicInt(&compaction->done, 1);
+
+  return 0;
+}
+
+static void compactionStart(Leaderboard *leaderboard) {
+  Compaction *compaction = &leaderboard->compaction;
+  Uint32 committed = journalCommitted(leaderboard);
+
+  compaction->tail = malloc(committed * sizeof(JournalEntry));
+  if (compaction->tail == NULL)
+    return;
+  memcpy(compaction->tail, leaderboard->tail, committed * sizeof(JournalEntry));
+
+  compaction->tailCount = committed;
+  compaction->foldedSeq = leaderboard->tail[committed - 1].seq;
+  snprintf(compaction->fileName, sizeof(compaction->fileName), "%s",
+           leaderboard->fileName);
+  snprintf(compaction->indexName, sizeof(compaction->indexName), "%s",
+           leaderboard->indexName);
+
+  SDL_SetAtomicInt(&compaction->done, 0);
+  compaction->thread =
+      SDL_CreateThread(compactionThread, "compaction", compaction);
+  if (compaction->thread == NULL) {
+    free(compaction->tail);
+    compaction->tail = NULL;
+    compaction->success = false;
+  }
+}
+
+static void compactionFinish(Leaderboard *leaderboard) {
+  Compaction *compaction = &leaderboard->compaction;
+
+  SDL_WaitThread(compaction->thread, NULL);
+  compaction->thread = NULL;
+  free(compaction->tail);
+  compaction->tail = NULL;
+
+  if (!compaction->success) { /* Not retried until the next launch */
+    printf("Unable to compact '%s'.\n", leaderboard->fileName);
+    return;
+  }
+
+  /* Swap in the new snapshot, IDs are renumbered in score order. It stays
+   * in memory, the file is mapped again on the next launch */
+  mapFree(&leaderboard->snapshotMap);
+  mapFree(&leaderboard->indexMap);
+  leaderboard->snapshotMap.data = compaction->records;
+  leaderboard->snapshotMap.size = compaction->count * sizeof(ScoreRecord);
+  leaderboard->snapshot = compaction->records;
+  leaderboard->indexMap.data = compaction->orderBuffer;
+  leaderboard->indexMap.size = 2 * compaction->count * sizeof(Uint32);
+  for (int type = 0; type < SORTCOUNT; type++)
+    leaderboard->orders[type] = compaction->orders[type];
+  leaderboard->savedStats = NULL;
+  leaderboard->savedPlayers = 0;
+  compaction->records = NULL;
+  compaction->orderBuffer = NULL;
+  nameIndexFree(&leaderboard->names);
+  leaderboard->names = compaction->names;
+  leaderboard->namesBuilt = true;
+  memset(&compaction->names, 0, sizeof(NameIndex));
+  leaderboard->count = compaction->count;
+  leaderboard->snapshotCount = compaction->count;
+  leaderboard->foldedSeq = compaction->foldedSeq;
+  leaderboard->generation++;
+  topRebuild(leaderboard);
+
+  /* Entries added since the compaction started keep their place. One that
+   * can't be indexed is dropped with the rest after it, so IDs stay paired
+   * with tail entries; the journal still has them for the next launch */
+  Uint32 folded = compaction->tailCount;
+  Uint32 pending = leaderboard->tailCount - folded;
+  memmove(leaderboard->tail, leaderboard->tail + folded,
+          pending * sizeof(JournalEntry));
+  leaderboard->tailCount = 0;
+  while (leaderboard->tailCount < pending) {
+    leaderboard->tailCount++;
+    if (!recordPush(leaderboard)) {
+      printf("Unable to index the score.\n");
+      leaderboard->tailCount--;
+      break;
+    }
+  }
+
+  /* The snapshot is synced by now, so the worker can drop the folded
+   * entries from the file when it's free */
+  JournalWriter *writer = &leaderboard->writer;
+  SDL_LockMutex(writer->lock);
+  writer->rewriteSeq = compaction->foldedSeq;
+  SDL_SignalCondition(writer->wake);
+  SDL_UnlockMutex(writer->lock);
+}
+
+void leaderboardPoll(Leaderboard *leaderboard) /* Once per frame, never
+                                                  touches a file */
+{
+  Compaction *compaction = &leaderboard->compaction;
+  if (compaction->thread != NULL) {
+    if (SDL_GetAtomicInt(&compaction->done))
+      compactionFinish(leaderboard);
+  } else if (compaction->success && leaderboard->writer.thread != NULL &&
+             leaderboard->tailCount >= JOURNAL_COMPACT_AT &&
+             journalCommitted(leaderboard) >= JOURNAL_COMPACT_AT) {
+    compactionStart(leaderboard);
+  }
+}
+
+static Uint32 snapshotAt(Leaderboard *leaderboard, enum Sort type,
+                         Uint32 rank) {
+  const Uint32 *order = leaderboard->orders[type];
+  return order != NULL ? order[rank] : rank;
+}
+
+Uint32 leaderboardAt(Leaderboard *leaderboard, enum Sort type,
+                     Uint32 rank) /* Record ID, rank < count. Searches for
+                                     how many of the first rank + 1 come
+                                     from the tail */
+{
+  const Uint32 *tail = leaderboard->tailOrders[type];
+  Uint32 tailCount = leaderboard->count - leaderboard->snapshotCount;
+  Uint32 taken = rank + 1;
+  Uint32 low = taken > leaderboard->snapshotCount
+                   ? taken - leaderboard->snapshotCount
+                   : 0;
+  Uint32 high = SDL_min(taken, tailCount);
+
+  /* Too few from the tail while its next one sorts before the snapshot's
+   * last one taken */
+  while (low < high) {
+    Uint32 fromTail = low + (high - low) / 2;
+    Uint32 fromSnapshot = taken - fromTail;
+    if (fromSnapshot > 0 &&
+        recordBefore(leaderboard, tail[fromTail],
+                     snapshotAt(leaderboard, type, fromSnapshot - 1), type))
+      low = fromTail + 1;
+    else
+      high = fromTail;
+  }
+
+  /* The last one taken is whichever of the two runs' last sorts behind */
+  Uint32 fromSnapshot = taken - low;
+  Uint32 snapshotLast =
+      fromSnapshot > 0 ? snapshotAt(leaderboard, type, fromSnapshot - 1) : 0;
+  if (low > 0 && (fromSnapshot == 0 || recordBefore(leaderboard, snapshotLast,
+                                                    tail[low - 1], type)))
+    return tail[low - 1];
+  return snapshotLast;
+}
+
+const ScoreRecord *leaderboardRecord(Leaderboard *leaderboard,
+                                     Uint32 id) /* Valid until the next
+                                                   append or poll */
+{
+  if (id >= leaderboard->count)
+    return NULL;
+
+  return recordAt(leaderboard, id);
+}
+
+int leaderboardTop(Leaderboard *leaderboard, enum Sort type,
+                   const ScoreRecord **records, Uint32 *ids,
+                   int rows) /* Best first by score or time, returns how
+                                many. Valid until the next append or poll */
+{
+  if (type >= NAME)
+    return 0;
+
+  /* Heap order -> Sorted, it's only TOPK_SIZE */
+  TopK *top = &leaderboard->top[type];
+  Uint32 order[TOPK_SIZE];
+  for (Uint32 i = 0; i < top->count; i++) {
+    Uint32 at = i;
+    for (; at > 0 && topBefore(top, i, order[at - 1], type); at--)
+      order[at] = order[at - 1];
+    order[at] = i;
+  }
+
+  int count = SDL_min(rows, (int)top->count);
+  for (int i = 0; i < count; i++) {
+    records[i] = &top->records[order[i]];
+    ids[i] = top->ids[order[i]];
+  }
+  return count;
+}
+
+Uint32 leaderboardPlayerCount(Leaderboard *leaderboard) {
+  return namesBuild(leaderboard) ? leaderboard->names.nameCount : 0;
+}
+
+Uint32 leaderboardPlayerAt(Leaderboard *leaderboard, enum Sort type,
+                           Uint32 rank) /* Name index by best score, total
+                                           time or name, SDL_MAX_UINT32 past
+                                           the player count */
+{
+  NameIndex *names = &leaderboard->names;
+  if (!namesBuild(leaderboard) || rank >= names->nameCount)
+    return SDL_MAX_UINT32; /* leaderboardPlayer gives NULL for it */
+
+  return type == NAME ? names->sorted[rank] : names->players[type][rank];
+}
+
+const NameEntry *leaderboardPlayer(Leaderboard *leaderboard, Uint32 player) {
+  if (player >= leaderboard->names.nameCount)
+    return NULL;
+
+  return &leaderboard->names.names[player];
+}
+
+const NameEntry *leaderboardFind(Leaderboard *leaderboard,
+                                 const char *username) /* NULL if the name
+                                                          has no scores */
+{
+  NameIndex *names = &leaderboard->names;
+  if (!namesBuild(leaderboard) || names->slotCount == 0)
+    return NULL;
+
+  int found = names->slots[nameSlot(names, username, nameHash(username))];
+  return found != -1 ? &names->names[found] : NULL;
+}
+
+static bool startsWith(const char *string, const char *prefix) {
+  return strncmp(string, prefix, strlen(prefix)) == 0;
+}
+
+static bool fuzzyPrefix(const char *folded,
+                        const char *prefix) /* Some start of folded is at most
+                                               one edit away from prefix */
+{
+  int i = 0;
+  while (prefix[i] != '\0' && folded[i] == prefix[i])
+    i++;
+  if (prefix[i] == '\0')
+    return true;
+
+  /* First mismatch -> Substitute, insert or delete one character */
+  if (folded[i] == '\0')
+    return prefix[i + 1] == '\0';
+  return startsWith(folded + i + 1, prefix + i + 1) ||
+         startsWith(folded + i + 1, prefix + i) ||
+         startsWith(folded + i, prefix + i + 1);
+}
+
+static Uint32 queryBound(NameIndex *names, const char *prefix,
+                         size_t length) /* First sorted name whose first
+                                           length characters are >= prefix */
+{
+  Uint32 low = 0, high = names->nameCount;
+  while (low < high) {
+    Uint32 mid = low + (high - low) / 2;
+    if (strncmp(names->names[names->sorted[mid]].folded, prefix, length) < 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  return low;
+}
+
+void leaderboardQuery(Leaderboard *leaderboard, LeaderboardQuery *query,
+                      const char *prefix) /* Cheap enough to call on every
+                                             keystroke */
+{
+  leaderboardQueryFree(query);
+  if (!namesBuild(leaderboard))
+    return;
+  for (int i = 0; i < USERNAME_MAX - 1 && prefix[i] != '\0'; i++)
+    query->prefix[i] = SDL_tolower((unsigned char)prefix[i]);
+  query->generation = leaderboard->generation;
+
+  /* Every name starting with prefix sits in one run of the sorted names */
+  NameIndex *names = &leaderboard->names;
+  size_t length = strlen(query->prefix);
+  query->first = queryBound(names, query->prefix, length);
+  query->last = query->first;
+  while (query->last < names->nameCount &&
+         startsWith(names->names[names->sorted[query->last]].folded,
+                    query->prefix)) {
+    query->matchCount += names->names[names->sorted[query->last]].count;
+    query->last++;
+  }
+  query->playerCount = query->last - query->first;
+
+  /* Nothing starts with it -> Try one typo away, a scan of distinct names */
+  if (query->matchCount == 0 && length >= 2) {
+    query->fuzzyNames = calloc(names->nameCount ? names->nameCount : 1, 1);
+    if (query->fuzzyNames == NULL)
+      return;
+    query->fuzzy = true;
+
+    for (Uint32 i = 0; i < names->nameCount; i++)
+      if (fuzzyPrefix(names->names[i].folded, query->prefix)) {
+        query->fuzzyNames[i] = 1;
+        query->matchCount += names->names[i].count;
+        query->playerCount++;
+      }
+  }
+}
+
+void leaderboardQueryRefresh(Leaderboard *leaderboard,
+                             LeaderboardQuery *query) /* Again if records
+                                                         changed since */
+{
+  if (query->generation != leaderboard->generation) {
+    char prefix[USERNAME_MAX];
+    memcpy(prefix, query->prefix, USERNAME_MAX);
+    leaderboardQuery(leaderboard, query, prefix);
+  }
+}
+
+static bool queryGather(Leaderboard *leaderboard, LeaderboardQuery *query,
+                        enum Sort type) {
+  IndexKey *keys = malloc(query->matchCount * sizeof(IndexKey));
+  Uint32 *results = realloc(query->results, query->matchCount * sizeof(Uint32));
+  if (keys == NULL || results == NULL) {
+    free(keys);
+    free(results);
+    query->results = NULL;
+    query->resultType = -1;
+    return false;
+  }
+  query->results = results;
+
+  /* Prefix -> Just the names in its run, fuzzy -> Every flagged name */
+  NameIndex *names = &leaderboard->names;
+  Uint32 first = query->fuzzy ? 0 : query->first;
+  Uint32 last = query->fuzzy ? names->nameCount : query->last;
+  Uint32 count = 0;
+  for (Uint32 i = first; i < last; i++) {
+    if (query->fuzzy && !query->fuzzyNames[names->sorted[i]])
+      continue;
+
+    NameEntry *entry = &names->names[names->sorted[i]];
+    for (Uint32 j = 0; j < entry->count; j++) {
+      keys[count].record = recordAt(leaderboard, entry->ids[type][j]);
+      keys[count].id = entry->ids[type][j];
+      keys[count].type = type;
+      count++;
+    }
+  }
+  qsort(keys, count, sizeof(IndexKey), compareIndexKeys);
+
+  for (Uint32 i = 0; i < count; i++)
+    query->results[i] = keys[i].id;
+  free(keys);
+
+  query->resultType = type;
+  query->front = count;
+  query->back = 0;
+  return true;
+}
+
+static void runLoad(Leaderboard *leaderboard, QueryRun *run, enum Sort type,
+                    int end) /* Next ID from the front (0) or the back (1) */
+{
+  const NameEntry *entry = &leaderboard->names.names[run->name];
+  run->id = entry->ids[type][end == 0 ? entry->count - run->left
+                                      : run->left - 1];
+  if (type != NAME) {
+    const ScoreRecord *record = recordAt(leaderboard, run->id);
+    run->key = type == SCORE ? record->score : record->time;
+  }
+}
+
+static bool runBefore(Leaderboard *leaderboard, const QueryRun *a,
+                      const QueryRun *b, enum Sort type,
+                      int end) /* Ties by ID, reversed from the back */
+{
+  int order = type == NAME ? compareRecords(recordAt(leaderboard, a->id),
+                                            recordAt(leaderboard, b->id), NAME)
+                           : (b->key > a->key) - (b->key < a->key);
+  if (order == 0)
+    order = (a->id > b->id) - (a->id < b->id);
+  return end == 0 ? order < 0 : order > 0;
+}
+
+static void runSiftDown(Leaderboard *leaderboard, LeaderboardQuery *query,
+                        int end, Uint32 at) {
+  QueryRun *runs = query->runs[end];
+  Uint32 count = query->runCount[end];
+  enum Sort type = query->resultType;
+
+  for (Uint32 child = 2 * at + 1; child < count;
+       at = child, child = 2 * at + 1) {
+    if (child + 1 < count &&
+        runBefore(leaderboard, &runs[child + 1], &runs[child], type, end))
+      child++;
+    if (!runBefore(leaderboard, &runs[child], &runs[at], type, end))
+      break;
+    QueryRun run = runs[at];
+    runs[at] = runs[child];
+    runs[child] = run;
+  }
+}
+
+static bool queryRuns(Leaderboard *leaderboard, LeaderboardQuery *query,
+                      int end) /* That end's heap, on its first merge */
+{
+  QueryRun *runs =
+      realloc(query->runs[end], query->playerCount * sizeof(QueryRun));
+  if (runs == NULL)
+    return false;
+  query->runs[end] = runs;
+
+  /* Prefix -> Just the names in its run, fuzzy -> Every flagged name */
+  NameIndex *names = &leaderboard->names;
+  Uint32 first = query->fuzzy ? 0 : query->first;
+  Uint32 last = query->fuzzy ? names->nameCount : query->last;
+  Uint32 count = 0;
+  for (Uint32 i = first; i < last; i++) {
+    Uint32 name = names->sorted[i];
+    if ((query->fuzzy && !query->fuzzyNames[name]) ||
+        names->names[name].count == 0)
+      continue;
+
+    runs[count].name = name;
+    runs[count].left = names->names[name].count;
+    runLoad(leaderboard, &runs[count], query->resultType, end);
+    count++;
+  }
+
+  query->runCount[end] = count;
+  for (Uint32 at = count / 2; at-- > 0;)
+    runSiftDown(leaderboard, query, end, at);
+  query->merging[end] = true;
+  return true;
+}
+
+static bool queryMergeStart(LeaderboardQuery *query,
+                            enum Sort type) /* Nothing merged yet */
+{
+  Uint32 *results = realloc(query->results, query->matchCount * sizeof(Uint32));
+  if (results == NULL) {
+    query->resultType = -1;
+    return false;
+  }
+  query->results = results;
+
+  query->resultType = type;
+  query->front = query->back = 0;
+  query->merging[0] = query->merging[1] = false;
+  return true;
+}
+
+static bool queryMerge(Leaderboard *leaderboard, LeaderboardQuery *query,
+                       int end, Uint32 target) /* Until that end's results
+                                                  reach target or the other
+                                                  end's */
+{
+  if (!query->merging[end] && !queryRuns(leaderboard, query, end))
+    return false;
+
+  QueryRun *runs = query->runs[end];
+  while (query->front + query->back < query->matchCount &&
+         query->runCount[end] > 0 &&
+         (end == 0 ? query->front < target
+                   : query->matchCount - query->back > target)) {
+    if (end == 0)
+      query->results[query->front++] = runs[0].id;
+    else
+      query->results[query->matchCount - ++query->back] = runs[0].id;
+
+    if (--runs[0].left == 0)
+      runs[0] = runs[--query->runCount[end]];
+    else
+      runLoad(leaderboard, &runs[0], query->resultType, end);
+    runSiftDown(leaderboard, query, end, 0);
+  }
+  return true;
+}
+
+int leaderboardQueryPage(Leaderboard *leaderboard, LeaderboardQuery *query,
+                         enum Sort type, Uint32 cursor, Uint32 *ids,
+                         int rows) /* Record IDs of matches cursor and on,
+                                      returns how many */
+{
+  leaderboardQueryRefresh(leaderboard, query);
+
+  int count = 0;
+  if (cursor >= query->matchCount)
+    return 0;
+  Uint32 last = SDL_min(cursor + rows, query->matchCount);
+
+  /* Every record matches -> The global order is the answer */
+  if (!query->fuzzy && query->matchCount == leaderboard->count) {
+    for (; cursor + count < last; count++)
+      ids[count] = leaderboardAt(leaderboard, type, cursor + count);
+    return count;
+  }
+
+  if (query->resultType != (int)type &&
+      !(query->matchCount <= QUERY_GATHER
+            ? queryGather(leaderboard, query, type)
+            : queryMergeStart(query, type)))
+    return 0;
+
+  /* Not merged yet -> From whichever end has less in between */
+  Uint32 backFirst = query->matchCount - query->back;
+  if (last > query->front && cursor < backFirst &&
+      !(last - query->front <= backFirst - cursor
+            ? queryMerge(leaderboard, query, 0, last)
+            : queryMerge(leaderboard, query, 1, cursor)))
+    return 0;
+
+  for (; cursor + count < last; count++)
+    ids[count] = query->results[cursor + count];
+  return count;
+}
+
+int leaderboardQueryPlayers(Leaderboard *leaderboard, LeaderboardQuery *query,
+                            Uint32 cursor, Uint32 *players,
+                            int rows) /* Matching names in name order,
+                                         returns how many */
+{
+  leaderboardQueryRefresh(leaderboard, query);
+  NameIndex *names = &leaderboard->names;
+
+  int count = 0;
+  if (!query->fuzzy) {
+    for (; count < rows && cursor + count < query->playerCount; count++)
+      players[count] = names->sorted[query->first + cursor + count];
+    return count;
+  }
+
+  /* Fuzzy matches are few but scattered, skip to the cursor'th */
+  for (Uint32 rank = 0, match = 0; count < rows && rank < names->nameCount;
+       rank++) {
+    if (!query->fuzzyNames[names->sorted[rank]])
+      continue;
+    if (match++ >= cursor)
+      players[count++] = names->sorted[rank];
+  }
+
+  return count;
+}
+
+void leaderboardQueryFree(LeaderboardQuery *query) {
+  free(query->results);
+  free(query->fuzzyNames);
+  for (int end = 0; end < 2; end++)
+    free(query->runs[end]);
+  memset(query, 0, sizeof(LeaderboardQuery));
+  query->resultType = -1;
+}
+
+void leaderboardClose(Leaderboard *leaderboard) /* Waits for compaction,
+                                                   then drains the queue */
+{
+  if (leaderboard->compaction.thread != NULL)
+    compactionFinish(leaderboard);
+  journalWriterStop(&leaderboard->writer);
+
+  free(leaderboard->tail);
+  for (int type = 0; type < SORTCOUNT; type++) {
+    free(leaderboard->tailOrders[type]);
+    leaderboard->tailOrders[type] = NULL;
+    leaderboard->orders[type] = NULL;
+  }
+  mapFree(&leaderboard->snapshotMap);
+  mapFree(&leaderboard->indexMap);
+  nameIndexFree(&leaderboard->names);
+
+  leaderboard->tail = NULL;
+  leaderboard->snapshot = NULL;
+  leaderboard->savedStats = NULL;
+  leaderboard->savedPlayers = 0;
+  leaderboard->namesBuilt = false;
+  leaderboard->tailCount = leaderboard->tailCapacity = 0;
+  leaderboard->count = 0;
+  leaderboard->snapshotCount = 0;
+}
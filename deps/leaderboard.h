@@ -0,0 +1,263 @@
+#ifndef LEADERBOARD_H_
+#define LEADERBOARD_H_
+
+#include "includes.h"
+
+#define LEADERBOARD_FILE "scores.bin"
+#define LEADERBOARD_JOURNAL_FILE "scores.journal"
+#define LEADERBOARD_INDEX_FILE "scores.idx"
+#define LEADERBOARD_LEGACY_FILE "scores.json" /* Migrated on first run */
+#define LEADERBOARD_MAGIC 0x424C3150 /* "P1LB" */
+#define LEADERBOARD_VERSION 2
+#define JOURNAL_MAGIC 0x4A4C3150 /* "P1LJ" */
+#define INDEX_MAGIC 0x58493150   /* "P1IX" */
+#define INDEX_VERSION 2
+#define SORTCOUNT 3 /* One index per enum Sort */
+#define USERNAME_MAX 56
+
+#define QUERY_GATHER 4096 /* Most matches a search sorts instead of merges */
+#define TOPK_SIZE 8 /* Best records kept resident, a page of the scores view */
+
+#define JOURNAL_GROUP_MAX 16  /* Pending entries that force a commit */
+#define JOURNAL_GROUP_MS 250  /* Longest a pending entry waits */
+#define JOURNAL_COMPACT_AT 128 /* Committed entries that start a compaction */
+#define JOURNAL_QUEUE_MAX 64   /* Queued entries before an append waits */
+
+/* Snapshot Layout -> Header, then count ScoreRecords sorted by score. Journal
+ * entries up to foldedSeq are already in it and are skipped on replay */
+typedef struct LeaderboardHeader {
+  Uint32 magic;
+  Uint32 version;
+  Uint32 recordSize;
+  Uint32 count;
+  Uint32 foldedSeq;
+  Uint32 reserved;
+} LeaderboardHeader;
+
+typedef struct ScoreRecord {
+  char username[USERNAME_MAX];
+  Sint32 score; /* Asteroids destroyed */
+  Sint32 time;  /* Seconds survived */
+  Sint64 timestamp; /* SDL_Time, 0 for migrated scores */
+} ScoreRecord;
+
+/* Index Layout -> Header, then count snapshot IDs in time order, count in
+ * name order and playerCount PlayerStats in name index order. Score order is
+ * the snapshot itself. Only used if it matches the snapshot's count and
+ * foldedSeq, rebuilt otherwise */
+typedef struct IndexHeader {
+  Uint32 magic;
+  Uint32 version;
+  Uint32 count;
+  Uint32 foldedSeq;
+  Uint32 playerCount;
+  Uint32 reserved;
+} IndexHeader;
+
+/* Totals over every score of one username, updated on insert */
+typedef struct PlayerStats {
+  Sint64 totalScore; /* Asteroids destroyed over all games */
+  Sint64 totalTime;  /* Seconds survived over all games */
+  Sint32 best;
+  Uint32 games;
+} PlayerStats;
+
+/* Journal Layout -> Entries back to back. Replay stops at the first entry
+ * whose checksum doesn't match, which is where a torn write would be */
+typedef struct JournalEntry {
+  Uint32 magic;
+  Uint32 seq;
+  ScoreRecord record;
+  Uint32 checksum; /* Over everything before it */
+  Uint32 reserved;
+} JournalEntry;
+
+/* Interned usernames, each with its record IDs in every sort's order. The
+ * slots are an open addressing hash table of indexes into names */
+typedef struct NameEntry {
+  char *name;
+  char *folded; /* Lowercase, what searches compare against */
+  unsigned int hash;
+  Uint32 *ids[SORTCOUNT];
+  Uint32 count;
+  Uint32 capacity;
+  PlayerStats stats;
+} NameEntry;
+
+typedef struct NameIndex {
+  NameEntry *names;
+  Uint32 nameCount;
+  Uint32 nameCapacity;
+
+  int *slots; /* Index into names or -1 */
+  Uint32 slotCount; /* Power of 2 */
+
+  Uint32 *sorted; /* Name indexes by folded name, for prefix ranges */
+  Uint32 *rank;   /* Inverse of sorted */
+  Uint32 *recordNames; /* Name index of every record ID */
+  Uint32 recordCapacity;
+
+  /* Name indexes by best score and by total time, name order is sorted */
+  Uint32 *players[NAME];
+  Uint32 *playerRank[NAME]; /* Inverse of players */
+} NameIndex;
+
+/* The best TOPK_SIZE records of one sort, copied so reading them never
+ * touches the snapshot. A min-heap with the weakest at the root, so an
+ * insert that doesn't make it costs one comparison */
+typedef struct TopK {
+  ScoreRecord records[TOPK_SIZE];
+  Uint32 ids[TOPK_SIZE];
+  Uint32 count;
+} TopK;
+
+/* One matching name's IDs not yet merged into a query's results */
+typedef struct QueryRun {
+  Uint32 name;
+  Uint32 left;
+  Uint32 id;  /* Next one from this end */
+  Sint32 key; /* Its score or time, so the heap rarely touches records */
+} QueryRun;
+
+/* A live search. Few matches are gathered and sorted once per sort type.
+ * Many are merged from their names' ID lists as pages ask for them, from
+ * the front and from the back, so only the matches between the nearer end
+ * and the cursor are visited and none of them twice */
+typedef struct LeaderboardQuery {
+  char prefix[USERNAME_MAX]; /* Folded */
+  bool fuzzy; /* Edit distance <= 1, used when the prefix has no match */
+  Uint32 generation;
+
+  Uint32 first, last; /* Range of sorted names that start with prefix */
+  Uint8 *fuzzyNames;  /* Match flag per name index, fuzzy only */
+  Uint32 matchCount;  /* Records */
+  Uint32 playerCount; /* Names */
+
+  Uint32 *results;
+  int resultType; /* Sort the results are in, -1 for none */
+  Uint32 front;   /* results [0, front) and the last back are in place */
+  Uint32 back;
+
+  QueryRun *runs[2]; /* Heaps by next ID from the front and from the back */
+  Uint32 runCount[2];
+  bool merging[2]; /* That end's heap is built */
+} LeaderboardQuery;
+
+/* Owns the journal file once the leaderboard is open. Appends queue their
+ * entries and return, the worker writes them in groups and drops folded
+ * entries from the file after a compaction. Every group and replaced file is
+ * synced to the disk first, so a power cut loses at most the queued scores */
+typedef struct JournalWriter {
+  SDL_Thread *thread;
+  SDL_Mutex *lock;
+  SDL_Condition *wake;    /* Entries queued, flush, rewrite or stop */
+  SDL_Condition *drained; /* Entries written */
+
+  JournalEntry queue[JOURNAL_QUEUE_MAX]; /* Ring */
+  Uint32 head;
+  Uint32 queued;
+  Uint64 queuedSince;
+  Uint32 writtenSeq; /* Last entry on disk */
+  Uint32 rewriteSeq; /* Drop entries up to it from the file, 0 for none */
+  bool flush;        /* Write without waiting for the group to fill */
+  bool failed;       /* Last write failed, retried after JOURNAL_GROUP_MS */
+  bool stop;
+
+  /* Worker only after open */
+  FILE *journal;
+  char journalName[256];
+  long journalEnd; /* Where the next group goes */
+} JournalWriter;
+
+/* A whole file, mapped read-only where the platform can, read into memory
+ * otherwise */
+typedef struct LeaderboardMap {
+  void *data;
+  size_t size;
+  bool mapped; /* Unmapped on free, freed otherwise */
+} LeaderboardMap;
+
+typedef struct Compaction {
+  SDL_Thread *thread;
+  SDL_AtomicInt done;
+  bool success;
+
+  char fileName[256];
+  char indexName[256];
+  JournalEntry *tail; /* Copy of the entries being folded */
+  Uint32 tailCount;
+  Uint32 foldedSeq;
+
+  /* Result, handed over to the Leaderboard when done */
+  ScoreRecord *records;
+  Uint32 count;
+  Uint32 *orderBuffer; /* Time then name order */
+  const Uint32 *orders[SORTCOUNT];
+  NameIndex names;
+} Compaction;
+
+/* Records [0, snapshotCount) are read in place from the mapped snapshot, the
+ * rest come from the journal tail. orders[sort] lists the snapshot's IDs in
+ * that sort's order, straight from the mapped index, and tailOrders[sort] the
+ * tail's, kept sorted on insert. Ranks merge the two, ties go to the older
+ * record. The name index is only built once something searches */
+typedef struct Leaderboard {
+  char fileName[256];
+  char journalName[256];
+  char indexName[256];
+
+  LeaderboardMap snapshotMap;
+  LeaderboardMap indexMap;
+  const ScoreRecord *snapshot;
+  const Uint32 *orders[SORTCOUNT]; /* NULL for score, the snapshot's order */
+  const PlayerStats *savedStats;   /* From the index, NULL if it had none */
+  Uint32 savedPlayers;
+  Uint32 count;
+  NameIndex names;
+  bool namesBuilt;
+  TopK top[NAME]; /* By score and by time */
+  Uint32 generation; /* Bumped whenever IDs or orders change */
+
+  Uint32 snapshotCount;
+  Uint32 foldedSeq;
+
+  JournalEntry *tail; /* Entries not in the snapshot, written or queued */
+  Uint32 *tailOrders[SORTCOUNT];
+  Uint32 tailCount;
+  Uint32 tailCapacity;
+  Uint32 nextSeq;
+  JournalWriter writer;
+
+  Compaction compaction;
+} Leaderboard;
+
+bool leaderboardCreate(const char *fileName, const ScoreRecord *records,
+                       Uint32 count);
+bool leaderboardOpen(Leaderboard *leaderboard, const char *fileName,
+                     const char *journalName, const char *indexName,
+                     const char *legacyFile);
+bool leaderboardAppend(Leaderboard *leaderboard, const ScoreRecord *record);
+bool leaderboardCommit(Leaderboard *leaderboard);
+void leaderboardPoll(Leaderboard *leaderboard);
+Uint32 leaderboardAt(Leaderboard *leaderboard, enum Sort type, Uint32 rank);
+const ScoreRecord *leaderboardRecord(Leaderboard *leaderboard, Uint32 id);
+int leaderboardTop(Leaderboard *leaderboard, enum Sort type,
+                   const ScoreRecord **records, Uint32 *ids, int rows);
+const NameEntry *leaderboardFind(Leaderboard *leaderboard,
+                                 const char *username);
+void leaderboardQuery(Leaderboard *leaderboard, LeaderboardQuery *query,
+                      const char *prefix);
+void leaderboardQueryRefresh(Leaderboard *leaderboard,
+                             LeaderboardQuery *query);
+int leaderboardQueryPage(Leaderboard *leaderboard, LeaderboardQuery *query,
+                         enum Sort type, Uint32 cursor, Uint32 *ids, int rows);
+int leaderboardQueryPlayers(Leaderboard *leaderboard, LeaderboardQuery *query,
+                            Uint32 cursor, Uint32 *players, int rows);
+void leaderboardQueryFree(LeaderboardQuery *query);
+Uint32 leaderboardPlayerCount(Leaderboard *leaderboard);
+Uint32 leaderboardPlayerAt(Leaderboard *leaderboard, enum Sort type,
+                           Uint32 rank);
+const NameEntry *leaderboardPlayer(Leaderboard *leaderboard, Uint32 player);
+void leaderboardClose(Leaderboard *leaderboard);
+
+#endif // LEADERBOARD_H_
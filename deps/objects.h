@@ -10,5 +10,11 @@
 #include "score.h"
 #include "init.h"
 #include "draw.h"
+#include "profile.h"
+#include "texture.h"
+#include "sound.h"
+#include "font.h"
+#include "leaderboard.h"
+#include "scoreview.h"
 
 #endif //OBJECTS_H_
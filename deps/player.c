@@ -331,8 +331,8 @@ void playerMovementHandler(Player *player, double delta) {
 }
 
 void playerPowerUpHandler(Player *player, PowerUpNode *powerUps,
-                          SDL_Texture *spriteSheet, Sprite *spriteList,
-                          Mix_Chunk *shieldUpSfx, Mix_Chunk *shieldDownSfx) {
+                          SpriteRegistry *sprites, Mix_Chunk *shieldUpSfx,
+                          Mix_Chunk *shieldDownSfx) {
   PowerUpNode *powerPtr = powerUps->nextPowerUp;
   while (powerPtr != NULL) {
     if (SDL_HasRectIntersectionFloat(&player->rect, &powerPtr->power.rect)) {
@@ -406,27 +406,27 @@ void playerPowerUpHandler(Player *player, PowerUpNode *powerUps,
   timerCalcTicks(&player->multiBullTimer);
 }
 
-void playerTextHandler(Player *player, TTF_TextEngine *gTextEngine,
-                       TTF_Font *kenVectorFont) {
+void playerTextHandler(Player *player, FontCache *fontCache) {
   /* Score */
-  char *score; /* Number of characters in "Score: 999" */
-  SDL_asprintf(&score, "Score: %lu",
-               player->score); /* To join string with int */
-  player->scoreText = TTF_CreateText(gTextEngine, kenVectorFont, score, 0);
-
-  char *armor;
-  SDL_asprintf(&armor, " - %i", player->armor);
-  player->armorText = TTF_CreateText(gTextEngine, kenVectorFont, armor, 0);
+  char score[32];
+  snprintf(score, sizeof(score), "Score: %lu",
+           player->score); /* To join string with int */
+  player->scoreText = fontText(fontCache, SMALLFONT, score);
+
+  char armor[16];
+  snprintf(armor, sizeof(armor), " - %i", player->armor);
+  player->armorText = fontText(fontCache, SMALLFONT, armor);
 }
 
 void playerRender(Player *player, SDL_Renderer *gRenderer,
-                  SDL_Texture *spriteSheet, Sprite *spriteList) {
+                  SpriteRegistry *sprites) {
   /* Render Stats */
   /* Armor */
-  SDL_FRect playerSpriteRect =
-      getSpriteRect(spriteList, "playerShip2_blue.png");
+  int playerSprite = spriteFind(sprites, "playerShip2_blue.png");
+  SDL_FRect playerSpriteRect = spriteRect(sprites, playerSprite);
   SDL_FRect armorIconRect = {10, 10, 20, 20};
-  SDL_RenderTexture(gRenderer, spriteSheet, &playerSpriteRect, &armorIconRect);
+  SDL_RenderTexture(gRenderer, spriteTexture(sprites, playerSprite),
+                    &playerSpriteRect, &armorIconRect);
   TTF_DrawRendererText(player->armorText, 35, 12.5);
 
   /* Score */
@@ -434,7 +434,8 @@ void playerRender(Player *player, SDL_Renderer *gRenderer,
                        WIDTH - strlen(player->scoreText->text) * 10, 10);
 
   /* PowerUps */
-  SDL_FRect shieldSpriteRect = getSpriteRect(spriteList, "shield3.png");
+  int shieldSprite = spriteFind(sprites, "shield3.png");
+  SDL_FRect shieldSpriteRect = spriteRect(sprites, shieldSprite);
   SDL_FRect shieldRect = shieldSpriteRect;
   shieldRect.x = player->posX + player->width / 2.f - shieldRect.w / 2.f;
   shieldRect.y = player->posY + player->height / 2.f - shieldRect.h / 2.f;
@@ -442,18 +443,21 @@ void playerRender(Player *player, SDL_Renderer *gRenderer,
 
   if (player->shieldTimer.started) {
     if (player->shieldBlinker.started && !player->shieldBlink)
-      SDL_RenderTextureRotated(gRenderer, spriteSheet, &shieldSpriteRect,
-                               &shieldRect, player->rot, NULL, SDL_FLIP_NONE);
+      SDL_RenderTextureRotated(gRenderer, spriteTexture(sprites, shieldSprite),
+                               &shieldSpriteRect, &shieldRect, player->rot,
+                               NULL, SDL_FLIP_NONE);
     else if (!player->shieldBlinker.started)
-      SDL_RenderTextureRotated(gRenderer, spriteSheet, &shieldSpriteRect,
-                               &shieldRect, player->rot, NULL, SDL_FLIP_NONE);
+      SDL_RenderTextureRotated(gRenderer, spriteTexture(sprites, shieldSprite),
+                               &shieldSpriteRect, &shieldRect, player->rot,
+                               NULL, SDL_FLIP_NONE);
   }
 
   /* Player Render */
   /* Player Icon */
   /* Stiching Two Textures Together */
   if (player->afterburning && player->moving) {
-    SDL_FRect fireSpriteRect = getSpriteRect(spriteList, "fire15.png");
+    int fireSprite = spriteFind(sprites, "fire15.png");
+    SDL_FRect fireSpriteRect = spriteRect(sprites, fireSprite);
     SDL_Texture *fireTexture = SDL_CreateTexture(
         gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
         player->rect.w, player->rect.h + fireSpriteRect.h);
@@ -463,7 +467,8 @@ void playerRender(Player *player, SDL_Renderer *gRenderer,
     SDL_FRect fireRect = {player->width / 2.f - fireSpriteRect.w / 2.f,
                           player->height, fireSpriteRect.w, fireSpriteRect.h};
 
-    SDL_RenderTexture(gRenderer, spriteSheet, &fireSpriteRect, &fireRect);
+    SDL_RenderTexture(gRenderer, spriteTexture(sprites, fireSprite),
+                      &fireSpriteRect, &fireRect);
 
     SDL_SetRenderTarget(gRenderer, NULL);
 
@@ -476,8 +481,9 @@ void playerRender(Player *player, SDL_Renderer *gRenderer,
     SDL_RenderTextureRotated(gRenderer, fireTexture, NULL, &renderRect,
                              player->rot, NULL, SDL_FLIP_NONE);
   }
-  SDL_RenderTextureRotated(gRenderer, spriteSheet, &playerSpriteRect,
-                           &player->rect, player->rot, NULL, SDL_FLIP_NONE);
+  SDL_RenderTextureRotated(gRenderer, spriteTexture(sprites, playerSprite),
+                           &playerSpriteRect, &player->rect, player->rot, NULL,
+                           SDL_FLIP_NONE);
 
   SDL_SetRenderDrawColor(gRenderer, 255, 0, 255, 255);
   // SDL_RenderRect(gRenderer, &player.rect);
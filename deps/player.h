@@ -5,6 +5,7 @@
 #include "timer.h"
 #include "powerup.h"
 #include "bullet.h"
+#include "font.h"
 
 typedef struct Player {
   short armor; /* 3 */
@@ -76,10 +77,9 @@ void playerShoot(Player *player, int num);
 void playerBulletHander(Player *player, double delta, Mix_Chunk *shootSfx); 
 void playerEventHandler(SDL_Event e, Player *player, enum State *gameState); 
 void playerMovementHandler(Player *player, double delta); 
-void playerTextHandler(Player *player, TTF_TextEngine *gTextEngine,
-                       TTF_Font *kenVectorFont);
-void playerPowerUpHandler(Player *player, PowerUpNode *powerUps, SDL_Texture *spriteSheet, Sprite *spriteList, Mix_Chunk *shieldUpSfx, Mix_Chunk *shieldDownSfx); 
-void playerRender(Player *player, SDL_Renderer *gRenderer, SDL_Texture *spriteSheet, Sprite *spriteList); 
+void playerTextHandler(Player *player, FontCache *fontCache);
+void playerPowerUpHandler(Player *player, PowerUpNode *powerUps, SpriteRegistry *sprites, Mix_Chunk *shieldUpSfx, Mix_Chunk *shieldDownSfx); 
+void playerRender(Player *player, SDL_Renderer *gRenderer, SpriteRegistry *sprites); 
 void playerDestroy(Player *player); 
 
 #endif //PLAYER_H_
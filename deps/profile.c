@@ -0,0 +1,215 @@
+#include "profile.h"
+#include "includes.h"
+#include "objects.h"
+
+#define BENCH_FILE "startup_bench.json"
+
+void profilerInit(Profiler *profiler) {
+  profiler->phaseCount = 0;
+  profiler->openPhase = -1;
+  profiler->origin = SDL_GetPerformanceCounter();
+  profiler->frequency = SDL_GetPerformanceFrequency();
+}
+
+void profileMark(Profiler *profiler,
+                 const char *name) /* Ends the running phase and starts the
+                                      next one */
+{
+  uint64 now = SDL_GetPerformanceCounter();
+
+  if (profiler->openPhase != -1)
+    profiler->phases[profiler->openPhase].end = now;
+  profiler->openPhase = -1;
+
+  if (profiler->phaseCount >= PROFILEMAX)
+    return;
+
+  ProfilePhase *phase = &profiler->phases[profiler->phaseCount];
+  snprintf(phase->name, sizeof(phase->name), "%s", name);
+  phase->start = now;
+  phase->end = now;
+  profiler->openPhase = profiler->phaseCount++;
+}
+
+void profileStop(Profiler *profiler) {
+  if (profiler->openPhase != -1)
+    profiler->phases[profiler->openPhase].end = SDL_GetPerformanceCounter();
+  profiler->openPhase = -1;
+}
+
+double profilePhaseMs(Profiler *profiler, int phase) {
+  ProfilePhase *p = &profiler->phases[phase];
+  return (p->end - p->start) * 1000.0 / profiler->frequency;
+}
+
+double profileTotalMs(Profiler *profiler) {
+  if (profiler->phaseCount == 0)
+    return 0;
+
+  uint64 end = profiler->phases[profiler->phaseCount - 1].end;
+  return (end - profiler->origin) * 1000.0 / profiler->frequency;
+}
+
+void profilePrint(Profiler *profiler) {
+  double total = profileTotalMs(profiler);
+
+  printf("=== Startup Profile ===\n");
+  printf("%-40s %10s %7s\n", "Phase", "ms", "%");
+  for (int i = 0; i < profiler->phaseCount; i++) {
+    double ms = profilePhaseMs(profiler, i);
+    printf("%-40s %10.3f %6.1f%%\n", profiler->phases[i].name, ms,
+           total > 0 ? 100 * ms / total : 0);
+  }
+  printf("%-40s %10.3f\n", "Total", total);
+}
+
+static bool writeJson(cJSON *root, const char *fileName) {
+  bool success = true;
+  char *jsonData = cJSON_Print(root);
+
+  FILE *jsonFile = fopen(fileName, "w");
+  if (jsonFile == NULL) {
+    printf("Unable to open '%s'.\n", fileName);
+    success = false;
+  } else {
+    fputs(jsonData, jsonFile);
+    fclose(jsonFile);
+  }
+
+  cJSON_free(jsonData);
+  return success;
+}
+
+bool profileSave(Profiler *profiler, const char *fileName) {
+  cJSON *root = cJSON_CreateObject();
+  cJSON *phases = cJSON_AddArrayToObject(root, "Phases");
+
+  for (int i = 0; i < profiler->phaseCount; i++) {
+    cJSON *phase = cJSON_CreateObject();
+    cJSON_AddStringToObject(phase, "Name", profiler->phases[i].name);
+    cJSON_AddNumberToObject(phase, "Ms", profilePhaseMs(profiler, i));
+    cJSON_AddItemToArray(phases, phase);
+  }
+  cJSON_AddNumberToObject(root, "TotalMs", profileTotalMs(profiler));
+
+  bool success = writeJson(root, fileName);
+  cJSON_Delete(root);
+  return success;
+}
+
+static cJSON *benchStats(const char *name, double *samples, int stride,
+                         int column, int runs) /* First run is cold, the rest
+                                                  are warm */
+{
+  double cold = samples[column];
+  double warmMin = 0, warmMax = 0, warmSum = 0;
+
+  for (int run = 1; run < runs; run++) {
+    double ms = samples[run * stride + column];
+    if (run == 1 || ms < warmMin)
+      warmMin = ms;
+    if (run == 1 || ms > warmMax)
+      warmMax = ms;
+    warmSum += ms;
+  }
+  double warmMean = runs > 1 ? warmSum / (runs - 1) : 0;
+
+  printf("%-40s %10.3f %10.3f %10.3f %10.3f\n", name, cold, warmMin, warmMean,
+         warmMax);
+
+  cJSON *stats = cJSON_CreateObject();
+  cJSON_AddStringToObject(stats, "Name", name);
+  cJSON_AddNumberToObject(stats, "ColdMs", cold);
+  cJSON_AddNumberToObject(stats, "WarmMinMs", warmMin);
+  cJSON_AddNumberToObject(stats, "WarmMeanMs", warmMean);
+  cJSON_AddNumberToObject(stats, "WarmMaxMs", warmMax);
+  return stats;
+}
+
+bool profileBenchStartup(const char *exePath, int runs) {
+  const char *childArgs[] = {exePath, "--profile-startup", "--startup-exit",
+                             NULL};
+  char names[PROFILEMAX][50] = {};
+  int phaseCount = 0;
+  int stride = PROFILEMAX + 1; /* Last Column -> Total */
+  double *samples = calloc(runs * stride, sizeof(double));
+  if (samples == NULL)
+    return false;
+  int completed = 0;
+
+  for (int run = 0; run < runs; run++) {
+    /* A run that fails before its first frame must not find the last one's */
+    remove(PROFILE_FILE);
+
+    /* Each run is a fresh process so every run pays the full launch cost */
+    SDL_Process *child = SDL_CreateProcess(childArgs, true);
+    if (child == NULL) {
+      printf("Startup run %i could not be launched! SDL Error: %s\n", run,
+             SDL_GetError());
+      break;
+    }
+
+    int exitCode = -1;
+    void *output = SDL_ReadProcess(child, NULL, &exitCode);
+    SDL_free(output);
+    SDL_DestroyProcess(child);
+    if (exitCode != 0) {
+      printf("Startup run %i failed with exit code %i\n", run, exitCode);
+      break;
+    }
+
+    char *jsonData = SDL_LoadFile(PROFILE_FILE, NULL);
+    cJSON *root = jsonData != NULL ? cJSON_ParseInsitu(jsonData) : NULL;
+    if (root == NULL) {
+      SDL_free(jsonData);
+      printf("'%s' could not be read after run %i\n", PROFILE_FILE, run);
+      break;
+    }
+
+    int i = 0;
+    cJSON *phase = NULL;
+    cJSON_ArrayForEach(phase, cJSON_GetObjectItem(root, "Phases")) {
+      if (i >= PROFILEMAX)
+        break;
+      if (run == 0)
+        snprintf(names[i], sizeof(names[i]), "%s",
+                 cJSON_GetStringValue(cJSON_GetObjectItem(phase, "Name")));
+      samples[run * stride + i] =
+          cJSON_GetNumberValue(cJSON_GetObjectItem(phase, "Ms"));
+      i++;
+    }
+    if (run == 0)
+      phaseCount = i;
+    samples[run * stride + PROFILEMAX] =
+        cJSON_GetNumberValue(cJSON_GetObjectItem(root, "TotalMs"));
+
+    cJSON_Delete(root);
+    SDL_free(jsonData); /* Names and strings pointed into it */
+    completed++;
+  }
+
+  if (completed == 0) {
+    free(samples);
+    return false;
+  }
+
+  printf("=== Startup Benchmark (%i runs) ===\n", completed);
+  printf("%-40s %10s %10s %10s %10s\n", "Phase", "Cold ms", "Warm Min",
+         "Warm Mean", "Warm Max");
+
+  cJSON *root = cJSON_CreateObject();
+  cJSON_AddNumberToObject(root, "Runs", completed);
+  cJSON *phases = cJSON_AddArrayToObject(root, "Phases");
+  for (int i = 0; i < phaseCount; i++)
+    cJSON_AddItemToArray(
+        phases, benchStats(names[i], samples, stride, i, completed));
+  cJSON_AddItemToObject(
+      root, "Total",
+      benchStats("Total", samples, stride, PROFILEMAX, completed));
+
+  bool success = writeJson(root, BENCH_FILE);
+  cJSON_Delete(root);
+  free(samples);
+
+  return success && completed == runs;
+}
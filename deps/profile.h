@@ -0,0 +1,33 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "includes.h"
+
+#define PROFILEMAX 40
+#define PROFILE_FILE "startup_profile.json" /* --profile-startup saves here */
+
+typedef struct ProfilePhase {
+  char name[50];
+  uint64 start; /* Performance Counter Ticks */
+  uint64 end;
+} ProfilePhase;
+
+typedef struct Profiler {
+  ProfilePhase phases[PROFILEMAX];
+  int phaseCount;
+  int openPhase; /* -1 -> No Phase Running */
+
+  uint64 origin;
+  uint64 frequency;
+} Profiler;
+
+void profilerInit(Profiler *profiler);
+void profileMark(Profiler *profiler, const char *name);
+void profileStop(Profiler *profiler);
+double profilePhaseMs(Profiler *profiler, int phase);
+double profileTotalMs(Profiler *profiler);
+void profilePrint(Profiler *profiler);
+bool profileSave(Profiler *profiler, const char *fileName);
+bool profileBenchStartup(const char *exePath, int runs);
+
+#endif // PROFILE_H_
@@ -16,6 +16,7 @@ char *extractScores(char *fileName) {
   char *jsonData = (char *)malloc(length + 1);
   fread(jsonData, 1, length, scoreJson);
   jsonData[length] = '\0';
+  fclose(scoreJson);
 
   return jsonData;
 }
@@ -44,7 +45,10 @@ char *updateScores(char *jsonData, char *username, int score, int time) {
   return jsonData;
 }
 
-bool saveScores(char *jsonData, char *fileName) {
+bool saveScores(const cJSON *root,
+                char *fileName) /* Streamed, the text is never whole in
+                                   memory */
+{
   bool success = true;
 
   FILE *scoresJson = fopen(fileName, "w");
@@ -52,8 +56,11 @@ bool saveScores(char *jsonData, char *fileName) {
     printf("Unable to open '%s'.", fileName);
     success = false;
   } else {
-    fputs(jsonData, scoresJson);
-    fclose(scoresJson);
+    success = cJSON_PrintToFile(root, false, scoresJson);
+    if (fclose(scoresJson) != 0)
+      success = false;
+    if (!success)
+      printf("Unable to write '%s'.", fileName);
   }
 
   return success;
@@ -89,28 +96,168 @@ int compareName(const void *a, const void *b) {
   return strncmp(name1, name2, 50);
 }
 
-void sortScores(cJSON *jsonData, enum Sort type) {
+void sortScores(cJSON *jsonData,
+                enum Sort type) /* Leaves "Scores" indexed for paging */
+{
   cJSON *scores = cJSON_GetObjectItem(jsonData, "Scores");
-  int count = cJSON_GetArraySize(scores);
-
-  if (count < 2)
-    return;
-
-  cJSON **scoreList = malloc(count * sizeof(cJSON *));
-  for (int i = 0; i < count; i++)
-    scoreList[i] = cJSON_GetArrayItem(scores, i);
 
   if (type == SCORE)
-    qsort(scoreList, count, sizeof(cJSON *), compareScores);
+    cJSON_SortArray(scores, compareScores);
   else if (type == TIME)
-    qsort(scoreList, count, sizeof(cJSON *), compareTime);
+    cJSON_SortArray(scores, compareTime);
   else
-    qsort(scoreList, count, sizeof(cJSON *), compareName);
+    cJSON_SortArray(scores, compareName);
+}
+
+/* Streaming -> The scores leaderboardMigrate took from a parsed tree, objects
+ * in the root's "Scores" with a string Username and number Score and Time,
+ * found token by token without building one */
+
+enum ScoreField { FIELD_USERNAME, FIELD_SCORE, FIELD_TIME, FIELDCOUNT };
 
-  cJSON *sortedScores = cJSON_CreateArray();
-  for (int i = 0; i < count; i++)
-    cJSON_AddItemToArray(sortedScores, cJSON_Duplicate(scoreList[i], 1));
+static const char *scoreFields[FIELDCOUNT] = {"Username", "Score", "Time"};
+
+typedef struct ScoreStream {
+  ScoreSink sink;
+  void *data;
+  bool stopped; /* By the sink, not the JSON */
+
+  int depth;       /* 1 in the root, 2 in Scores, 3 in one score */
+  bool scoresKey;  /* Next root value is Scores */
+  bool scoresSeen; /* Only the first counts, as with cJSON_GetObjectItem */
+  bool inScores;
+
+  int field;   /* What the next value fills, -1 for nothing */
+  Uint8 seen;  /* Bit per field, the first of a repeated key decides */
+  Uint8 valid; /* Bit per field of the right type */
+  ScoreRecord record;
+} ScoreStream;
+
+static void streamValue(ScoreStream *stream) /* After any value */
+{
+  if (stream->depth == 1)
+    stream->scoresKey = false;
+  if (stream->field != -1)
+    stream->seen |= 1 << stream->field;
+  stream->field = -1;
+}
 
-  cJSON_ReplaceItemInObject(jsonData, "Scores", sortedScores);
-  free(scoreList);
+static cJSON_bool streamOpen(void *user) {
+  ScoreStream *stream = user;
+  bool scores = stream->depth == 1 && stream->scoresKey;
+  streamValue(stream);
+
+  stream->depth++;
+  if (scores) {
+    stream->inScores = true;
+  } else if (stream->depth == 3 && stream->inScores) {
+    memset(&stream->record, 0, sizeof(ScoreRecord));
+    stream->seen = 0;
+    stream->valid = 0;
+  }
+  return true;
+}
+
+static cJSON_bool streamClose(void *user) {
+  ScoreStream *stream = user;
+  if (stream->depth == 3 && stream->inScores &&
+      stream->valid == (1 << FIELDCOUNT) - 1 &&
+      !stream->sink(stream->data, &stream->record)) {
+    stream->stopped = true;
+    return false;
+  }
+
+  if (stream->depth == 2)
+    stream->inScores = false;
+  stream->depth--;
+  return true;
+}
+
+static cJSON_bool streamKey(void *user, const char *key) {
+  ScoreStream *stream = user;
+  if (stream->depth == 1) {
+    stream->scoresKey =
+        !stream->scoresSeen && SDL_strcasecmp(key, "Scores") == 0;
+    stream->scoresSeen |= stream->scoresKey;
+  } else if (stream->depth == 3 && stream->inScores) {
+    stream->field = -1;
+    for (int i = 0; i < FIELDCOUNT; i++)
+      if (!(stream->seen & 1 << i) && SDL_strcasecmp(key, scoreFields[i]) == 0)
+        stream->field = i;
+  }
+  return true;
+}
+
+static cJSON_bool streamString(void *user, const char *value) {
+  ScoreStream *stream = user;
+  if (stream->field == FIELD_USERNAME) {
+    snprintf(stream->record.username, sizeof(stream->record.username), "%s",
+             value);
+    stream->valid |= 1 << FIELD_USERNAME;
+  }
+  streamValue(stream);
+  return true;
+}
+
+static cJSON_bool streamNumber(void *user, double value) {
+  ScoreStream *stream = user;
+  /* Saturates like valueint */
+  Sint32 number = value >= SDL_MAX_SINT32   ? SDL_MAX_SINT32
+                  : value <= SDL_MIN_SINT32 ? SDL_MIN_SINT32
+                                            : (Sint32)value;
+  if (stream->field == FIELD_SCORE)
+    stream->record.score = number;
+  else if (stream->field == FIELD_TIME)
+    stream->record.time = number;
+  if (stream->field == FIELD_SCORE || stream->field == FIELD_TIME)
+    stream->valid |= 1 << stream->field;
+  streamValue(stream);
+  return true;
+}
+
+static cJSON_bool streamBoolean(void *user, cJSON_bool value) {
+  streamValue(user);
+  return true;
+}
+
+static cJSON_bool streamNull(void *user) {
+  streamValue(user);
+  return true;
+}
+
+bool streamScores(FILE *file, const char *fileName, ScoreSink sink, void *data,
+                  Uint64 *bytes) /* To the end of file, bytes counts what was
+                                    read */
+{
+  cJSON_SaxHandler handler = {streamOpen, streamClose,  streamOpen,
+                              streamClose, streamKey,   streamString,
+                              streamNumber, streamBoolean, streamNull};
+  ScoreStream stream = {};
+  stream.sink = sink;
+  stream.data = data;
+  stream.field = -1;
+
+  char *chunk = malloc(SCORE_CHUNK);
+  cJSON_Sax *sax = chunk != NULL ? cJSON_SaxCreate(&handler, &stream) : NULL;
+  if (sax == NULL) {
+    printf("Not enough memory to read '%s'.\n", fileName);
+    free(chunk);
+    return false;
+  }
+
+  bool success = true;
+  size_t length;
+  while (success && (length = fread(chunk, 1, SCORE_CHUNK, file)) > 0) {
+    if (bytes != NULL)
+      *bytes += length;
+    success = cJSON_SaxFeed(sax, chunk, length);
+  }
+  success = success && cJSON_SaxFinish(sax);
+  if (!success && !stream.stopped)
+    printf("'%s' is not valid JSON near byte %llu.\n", fileName,
+           (unsigned long long)cJSON_SaxOffset(sax));
+
+  cJSON_SaxDelete(sax);
+  free(chunk);
+  return success;
 }
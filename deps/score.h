@@ -2,6 +2,12 @@
 #define SCORE_H_
 
 #include "includes.h"
+#include "leaderboard.h"
+
+#define SCORE_CHUNK (64 * 1024) /* Read at a time when streaming */
+
+/* Gets each score a stream finds, false stops it */
+typedef bool (*ScoreSink)(void *data, const ScoreRecord *record);
 
 typedef struct ScoreObj {
   char username[50];
@@ -11,10 +17,12 @@ typedef struct ScoreObj {
 
 char *extractScores(char *fileName); 
 char *updateScores(char *jsonData, char *username, int score, int time); 
-bool saveScores(char *jsonData, char *fileName); 
+bool saveScores(const cJSON *root, char *fileName); 
 int compareScores(const void *a, const void *b); 
 int compareTime(const void *a, const void *b); 
 int compareName(const void *a, const void *b); 
 void sortScores(cJSON *jsonData, enum Sort type); 
+bool streamScores(FILE *file, const char *fileName, ScoreSink sink, void *data,
+                  Uint64 *bytes);
 
 #endif //SCORE_H_
@@ -0,0 +1,174 @@
+#include "scoreview.h"
+#include "includes.h"
+#include "objects.h"
+
+void scoreViewInit(ScoreView *view, TTF_TextEngine *gTextEngine,
+                   TTF_Font *font) {
+  memset(view, 0, sizeof(ScoreView));
+  view->gTextEngine = gTextEngine;
+  view->font = font;
+  view->type = SCORE;
+  view->columns = 3;
+  for (int i = 0; i < VIEW_SLOTS; i++)
+    view->rows[i].rank = VIEW_STALE;
+}
+
+void scoreViewReset(ScoreView *view) /* Different rows, back to the top */
+{
+  for (int i = 0; i < VIEW_SLOTS; i++)
+    view->rows[i].rank = VIEW_STALE;
+  view->position = 0;
+  view->target = 0;
+}
+
+void scoreViewSetPlayers(ScoreView *view, bool players) {
+  view->players = players;
+  view->columns = players ? VIEW_COLUMNS : 3;
+  scoreViewReset(view);
+}
+
+static Uint32 viewMaxTop(ScoreView *view) {
+  return view->rowCount > VIEW_ROWS ? view->rowCount - VIEW_ROWS : 0;
+}
+
+void scoreViewScroll(ScoreView *view, int rows) {
+  Sint64 target = (Sint64)view->target + rows;
+  view->target = SDL_clamp(target, 0, (Sint64)viewMaxTop(view));
+}
+
+void scoreViewJump(ScoreView *view, Uint32 rank) /* Slides in the last page
+                                                    only, however far */
+{
+  view->target = SDL_min(rank, viewMaxTop(view));
+
+  if (view->position > view->target + VIEW_ROWS)
+    view->position = view->target + VIEW_ROWS;
+  else if (view->position + VIEW_ROWS < view->target)
+    view->position = view->target - VIEW_ROWS;
+}
+
+static void viewRowFill(ScoreView *view, ViewRow *row, Uint32 rank,
+                        Uint32 id, const ScoreRecord *record,
+                        Leaderboard *leaderboard) /* record NULL to look it
+                                                     up by id */
+{
+  char strings[VIEW_COLUMNS][USERNAME_MAX + 16];
+  if (view->players) {
+    const NameEntry *player = leaderboardPlayer(leaderboard, id);
+    snprintf(strings[0], sizeof(strings[0]), "%u. %s", rank + 1,
+             player->name);
+    snprintf(strings[1], sizeof(strings[1]), "%i", player->stats.best);
+    snprintf(strings[2], sizeof(strings[2]), "%lli",
+             (long long)player->stats.totalScore);
+    snprintf(strings[3], sizeof(strings[3]), "%lli",
+             (long long)player->stats.totalTime);
+    snprintf(strings[4], sizeof(strings[4]), "%u", player->stats.games);
+  } else {
+    if (record == NULL)
+      record = leaderboardRecord(leaderboard, id);
+    snprintf(strings[0], sizeof(strings[0]), "%u. %s", rank + 1,
+             record->username);
+    snprintf(strings[1], sizeof(strings[1]), "%i", record->score);
+    snprintf(strings[2], sizeof(strings[2]), "%i", record->time);
+  }
+
+  for (int i = 0; i < view->columns; i++) {
+    if (row->texts[i] == NULL)
+      row->texts[i] =
+          TTF_CreateText(view->gTextEngine, view->font, strings[i], 0);
+    else
+      TTF_SetTextString(row->texts[i], strings[i], 0);
+  }
+  row->rank = rank;
+  row->id = id;
+}
+
+void scoreViewUpdate(ScoreView *view, Leaderboard *leaderboard,
+                     LeaderboardQuery *query,
+                     enum Sort type) /* Once per frame, query NULL for all */
+{
+  /* Other records behind the same ranks -> Drop what was fetched */
+  if (type != view->type || leaderboard->generation != view->generation) {
+    for (int i = 0; i < VIEW_SLOTS; i++)
+      view->rows[i].rank = VIEW_STALE;
+    view->type = type;
+    view->generation = leaderboard->generation;
+  }
+
+  if (query != NULL)
+    leaderboardQueryRefresh(leaderboard, query);
+  if (view->players)
+    view->rowCount = query != NULL ? query->playerCount
+                                   : leaderboardPlayerCount(leaderboard);
+  else
+    view->rowCount = query != NULL ? query->matchCount : leaderboard->count;
+  view->target = SDL_min(view->target, viewMaxTop(view));
+  view->position = SDL_min(view->position, (double)viewMaxTop(view));
+
+  Uint64 now = SDL_GetTicks();
+  double step = SDL_min((now - view->lastTicks) / VIEW_EASE_MS, 1.0);
+  view->lastTicks = now;
+  view->position += (view->target - view->position) * step;
+  if (SDL_fabs(view->target - view->position) < 0.01)
+    view->position = view->target;
+
+  /* Window -> The page above, the visible one and the page below */
+  Uint32 top = (Uint32)view->position;
+  Uint32 first = top > VIEW_ROWS ? top - VIEW_ROWS : 0;
+  Uint32 last = SDL_min(top + 2 * VIEW_ROWS, view->rowCount);
+  Uint32 ids[VIEW_ROWS];
+  const ScoreRecord *records[VIEW_ROWS];
+  const ScoreRecord *topRecords[TOPK_SIZE];
+  Uint32 topIds[TOPK_SIZE];
+
+  for (Uint32 rank = first; rank < last;) {
+    if (view->rows[rank % VIEW_SLOTS].rank == rank) {
+      rank++;
+      continue;
+    }
+
+    int count = SDL_min(last - rank, VIEW_ROWS);
+    for (int i = 0; i < count; i++)
+      records[i] = NULL;
+
+    /* Filtered players come in name order, where their matches are a run */
+    if (view->players && query != NULL)
+      count = leaderboardQueryPlayers(leaderboard, query, rank, ids, count);
+    else if (view->players)
+      for (int i = 0; i < count; i++)
+        ids[i] = leaderboardPlayerAt(leaderboard, type, rank + i);
+    else if (query != NULL)
+      count = leaderboardQueryPage(leaderboard, query, type, rank, ids, count);
+    else if (type != NAME && rank < TOPK_SIZE) { /* Resident, no lookups */
+      int topCount =
+          leaderboardTop(leaderboard, type, topRecords, topIds, TOPK_SIZE);
+      count = SDL_min(count, topCount - (int)rank);
+      for (int i = 0; i < count; i++) {
+        ids[i] = topIds[rank + i];
+        records[i] = topRecords[rank + i];
+      }
+    } else
+      for (int i = 0; i < count; i++)
+        ids[i] = leaderboardAt(leaderboard, type, rank + i);
+    if (count == 0)
+      break;
+
+    for (int i = 0; i < count; i++)
+      viewRowFill(view, &view->rows[(rank + i) % VIEW_SLOTS], rank + i,
+                  ids[i], records[i], leaderboard);
+    rank += count;
+  }
+}
+
+const ViewRow *scoreViewRow(ScoreView *view, Uint32 rank) {
+  const ViewRow *row = &view->rows[rank % VIEW_SLOTS];
+  return row->rank == rank ? row : NULL;
+}
+
+void scoreViewDestroy(ScoreView *view) /* Before the text engine */
+{
+  for (int i = 0; i < VIEW_SLOTS; i++)
+    for (int j = 0; j < VIEW_COLUMNS; j++)
+      TTF_DestroyText(view->rows[i].texts[j]);
+  memset(view, 0, sizeof(ScoreView));
+}
@@ -0,0 +1,53 @@
+#ifndef SCOREVIEW_H_
+#define SCOREVIEW_H_
+
+#include "includes.h"
+#include "leaderboard.h"
+
+#define VIEW_ROWS 8 /* On screen at once */
+#define VIEW_SLOTS (3 * VIEW_ROWS) /* Previous, visible and next page */
+#define VIEW_EASE_MS 120.f /* Roughly how long a scroll takes to settle */
+#define VIEW_STALE 0xFFFFFFFF
+#define VIEW_COLUMNS 5 /* Players view, the scores view uses 3 */
+
+/* One materialized row, its texts shaped once and reused while it stays in
+ * the window */
+typedef struct ViewRow {
+  Uint32 rank; /* Position in the current filter, VIEW_STALE if empty */
+  Uint32 id;   /* Record ID, or name index in the players view */
+  TTF_Text *texts[VIEW_COLUMNS]; /* Rank and username, then score and time
+                                    or best, totals and games */
+} ViewRow;
+
+/* A window over the leaderboard. Only the ranks around the visible page are
+ * fetched, each into slot rank % VIEW_SLOTS, so scrolling by a row fetches
+ * and shapes one row however deep it is */
+typedef struct ScoreView {
+  TTF_TextEngine *gTextEngine;
+  TTF_Font *font;
+  ViewRow rows[VIEW_SLOTS];
+  bool players; /* One row per username from its stats */
+  int columns;
+
+  enum Sort type;
+  Uint32 generation; /* Leaderboard's, when the rows were fetched */
+  Uint32 rowCount;
+
+  double position; /* First visible rank, eases toward target. Double so
+                    * fractions survive ranks in the millions */
+  Uint32 target;
+  Uint64 lastTicks;
+} ScoreView;
+
+void scoreViewInit(ScoreView *view, TTF_TextEngine *gTextEngine,
+                   TTF_Font *font);
+void scoreViewReset(ScoreView *view);
+void scoreViewSetPlayers(ScoreView *view, bool players);
+void scoreViewScroll(ScoreView *view, int rows);
+void scoreViewJump(ScoreView *view, Uint32 rank);
+void scoreViewUpdate(ScoreView *view, Leaderboard *leaderboard,
+                     LeaderboardQuery *query, enum Sort type);
+const ViewRow *scoreViewRow(ScoreView *view, Uint32 rank);
+void scoreViewDestroy(ScoreView *view);
+
+#endif // SCOREVIEW_H_
@@ -0,0 +1,132 @@
+#include "sound.h"
+#include "includes.h"
+#include "objects.h"
+
+bool soundBankOpen(SoundBank *bank,
+                   const char *fileName) /* Whole bank in one read */
+{
+  bank->data = NULL;
+  bank->size = 0;
+
+  size_t size;
+  Uint8 *data = SDL_LoadFile(fileName, &size);
+  if (data == NULL)
+    return false;
+
+  SoundBankHeader *header = (SoundBankHeader *)data;
+  int freq, channels;
+  SDL_AudioFormat format;
+  bool valid = size >= sizeof(SoundBankHeader) &&
+               header->magic == SOUNDBANK_MAGIC &&
+               header->version == SOUNDBANK_VERSION &&
+               size >= sizeof(SoundBankHeader) +
+                           header->count * sizeof(SoundBankEntry);
+
+  /* PCM is only usable as-is if the device opened with the same spec */
+  if (valid && Mix_QuerySpec(&freq, &format, &channels))
+    valid = header->freq == freq && header->format == format &&
+            header->channels == channels;
+
+  SoundBankEntry *entries = (SoundBankEntry *)(header + 1);
+  for (Uint32 i = 0; valid && i < header->count; i++)
+    valid = entries[i].offset <= size &&
+            entries[i].length <= size - entries[i].offset;
+
+  if (!valid) {
+    printf("'%s' does not match the mixer output, decoding sound effects "
+           "instead.\n",
+           fileName);
+    SDL_free(data);
+    return false;
+  }
+
+  bank->data = data;
+  bank->size = size;
+  return true;
+}
+
+Mix_Chunk *soundLoad(SoundBank *bank,
+                     const char *fileName) /* Bank first, decoder otherwise */
+{
+  if (bank->data != NULL) {
+    SoundBankHeader *header = (SoundBankHeader *)bank->data;
+    SoundBankEntry *entries = (SoundBankEntry *)(header + 1);
+
+    for (Uint32 i = 0; i < header->count; i++)
+      if (strncmp(entries[i].name, fileName, sizeof(entries[i].name)) == 0)
+        return Mix_QuickLoad_RAW(bank->data + entries[i].offset,
+                                 entries[i].length);
+  }
+
+  return Mix_LoadWAV(fileName);
+}
+
+void soundBankClose(SoundBank *bank) {
+  SDL_free(bank->data);
+  bank->data = NULL;
+  bank->size = 0;
+}
+
+bool soundBankBuild(const char *fileName, char **sources,
+                    int count) /* Needs the mixer opened with the game's spec */
+{
+  SoundBankHeader header;
+  header.magic = SOUNDBANK_MAGIC;
+  header.version = SOUNDBANK_VERSION;
+  header.count = count;
+
+  SDL_AudioFormat format;
+  if (!Mix_QuerySpec(&header.freq, &format, &header.channels)) {
+    printf("SDL_mixer is not open! SDL_mixer Error: %s\n", SDL_GetError());
+    return false;
+  }
+  header.format = format;
+
+  Mix_Chunk **chunks = calloc(count, sizeof(Mix_Chunk *));
+  SoundBankEntry *entries = calloc(count, sizeof(SoundBankEntry));
+  bool success = true;
+
+  Uint32 offset = sizeof(SoundBankHeader) + count * sizeof(SoundBankEntry);
+  for (int i = 0; i < count && success; i++) {
+    chunks[i] = Mix_LoadWAV(sources[i]);
+    if (chunks[i] == NULL) {
+      printf("'%s' could not be loaded! SDL_mixer Error: %s\n", sources[i],
+             SDL_GetError());
+      success = false;
+      break;
+    }
+
+    offset = (offset + SOUNDBANK_ALIGN - 1) & ~(SOUNDBANK_ALIGN - 1);
+    snprintf(entries[i].name, sizeof(entries[i].name), "%s", sources[i]);
+    entries[i].offset = offset;
+    entries[i].length = chunks[i]->alen;
+    offset += chunks[i]->alen;
+  }
+
+  FILE *bankFile = success ? fopen(fileName, "wb") : NULL;
+  if (success && bankFile == NULL) {
+    printf("Unable to open '%s'.\n", fileName);
+    success = false;
+  }
+
+  if (success) {
+    fwrite(&header, sizeof(header), 1, bankFile);
+    fwrite(entries, sizeof(SoundBankEntry), count, bankFile);
+    for (int i = 0; i < count; i++) {
+      fseek(bankFile, entries[i].offset, SEEK_SET);
+      fwrite(chunks[i]->abuf, 1, chunks[i]->alen, bankFile);
+    }
+    success = ferror(bankFile) == 0;
+    fclose(bankFile);
+    if (!success)
+      remove(fileName);
+  }
+
+  for (int i = 0; i < count; i++)
+    if (chunks[i] != NULL)
+      Mix_FreeChunk(chunks[i]);
+  free(chunks);
+  free(entries);
+
+  return success;
+}
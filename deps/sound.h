@@ -0,0 +1,41 @@
+#ifndef SOUND_H_
+#define SOUND_H_
+
+#include "includes.h"
+
+/* Mixer output spec, shared by init() and the sound bank builder */
+#define SOUND_FREQ 44100
+#define SOUND_CHANNELS 2
+
+#define SOUNDBANK_FILE "Assets/SoundEffects/sfx.bank"
+#define SOUNDBANK_MAGIC 0x4B423150 /* "P1BK" */
+#define SOUNDBANK_VERSION 1
+#define SOUNDBANK_ALIGN 16
+
+/* File Layout -> Header, count Entries, then the PCM data */
+typedef struct SoundBankHeader {
+  Uint32 magic;
+  Uint32 version;
+  Sint32 freq;
+  Uint32 format; /* SDL_AudioFormat */
+  Sint32 channels;
+  Uint32 count;
+} SoundBankHeader;
+
+typedef struct SoundBankEntry {
+  char name[64]; /* Source path, e.g. "Assets/SoundEffects/sfx_zap.ogg" */
+  Uint32 offset; /* From the start of the file */
+  Uint32 length;
+} SoundBankEntry;
+
+typedef struct SoundBank {
+  Uint8 *data; /* Chunks point into this, keep it until they are freed */
+  size_t size;
+} SoundBank;
+
+bool soundBankOpen(SoundBank *bank, const char *fileName);
+Mix_Chunk *soundLoad(SoundBank *bank, const char *fileName);
+void soundBankClose(SoundBank *bank);
+bool soundBankBuild(const char *fileName, char **sources, int count);
+
+#endif // SOUND_H_
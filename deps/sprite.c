@@ -3,38 +3,178 @@
 #include "objects.h"
 
 /* Sprite Definitions */
-/* Struct */
+/* Registry */
 
-SDL_FRect getSpriteRect(Sprite *spriteList, const char *spriteName) {
-  SDL_FRect spriteRect = {0, 0, 0, 0};
+static unsigned int spriteHash(const char *spriteName) /* FNV-1a */
+{
+  unsigned int hash = 2166136261u;
+  for (int i = 0; spriteName[i] != '\0' && i < 49; i++) {
+    hash ^= (unsigned char)spriteName[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+void spriteRegistryInit(SpriteRegistry *sprites) {
+  sprites->sprites = NULL;
+  sprites->spriteCount = 0;
+  sprites->spriteCapacity = 0;
+
+  sprites->slots = NULL;
+  sprites->slotCount = 0;
+
+  sprites->atlases = NULL;
+  sprites->atlasCount = 0;
+}
+
+void spriteRegistryDestroy(SpriteRegistry *sprites) {
+  for (int i = 0; i < sprites->atlasCount; i++)
+    SDL_DestroyTexture(sprites->atlases[i]);
+
+  free(sprites->atlases);
+  free(sprites->slots);
+  free(sprites->sprites);
+  spriteRegistryInit(sprites);
+}
+
+static int spriteSlot(SpriteRegistry *sprites,
+                      const char *spriteName) /* Slot holding the name, or the
+                                                 empty slot it would go in */
+{
+  unsigned int mask = sprites->slotCount - 1;
+  unsigned int slot = spriteHash(spriteName) & mask;
+
+  while (sprites->slots[slot] != -1 &&
+         strncmp(sprites->sprites[sprites->slots[slot]].name, spriteName,
+                 50) != 0)
+    slot = (slot + 1) & mask; /* Linear probing */
+
+  return slot;
+}
+
+static bool spriteRehash(SpriteRegistry *sprites, int slotCount) {
+  int *slots = malloc(slotCount * sizeof(int));
+  if (slots == NULL)
+    return false;
+
+  free(sprites->slots);
+  sprites->slots = slots;
+  sprites->slotCount = slotCount;
+  for (int i = 0; i < slotCount; i++)
+    sprites->slots[i] = -1;
+
+  /* Later IDs win so a pack can override a sprite by name */
+  for (int id = 0; id < sprites->spriteCount; id++)
+    sprites->slots[spriteSlot(sprites, sprites->sprites[id].name)] = id;
+
+  return true;
+}
+
+int spriteAdd(SpriteRegistry *sprites, const Sprite *sprite) {
+  if (sprites->spriteCount == sprites->spriteCapacity) {
+    int capacity = sprites->spriteCapacity ? sprites->spriteCapacity * 2 : 64;
+    Sprite *grown = realloc(sprites->sprites, capacity * sizeof(Sprite));
+    if (grown == NULL)
+      return -1;
+    sprites->sprites = grown;
+    sprites->spriteCapacity = capacity;
+  }
+
+  int id = sprites->spriteCount++;
+  sprites->sprites[id] = *sprite;
 
-  for (int i = 0; i < SPRITEMAX; i++)
-    if (strncmp(spriteList[i].name, spriteName, 50) == 0) {
-      spriteRect.x = spriteList[i].x;
-      spriteRect.y = spriteList[i].y;
-      spriteRect.w = spriteList[i].width;
-      spriteRect.h = spriteList[i].height;
-      break;
+  /* Keep the table at most half full */
+  if (sprites->spriteCount * 2 > sprites->slotCount) {
+    int slotCount = sprites->slotCount ? sprites->slotCount * 2 : 128;
+    if (!spriteRehash(sprites, slotCount)) {
+      sprites->spriteCount--;
+      return -1;
     }
+  } else {
+    sprites->slots[spriteSlot(sprites, sprite->name)] = id;
+  }
+
+  return id;
+}
+
+int spriteFind(SpriteRegistry *sprites, const char *spriteName) {
+  if (sprites->slotCount == 0)
+    return -1;
+
+  return sprites->slots[spriteSlot(sprites, spriteName)];
+}
+
+SDL_FRect spriteRect(SpriteRegistry *sprites, int id) {
+  SDL_FRect spriteRect = {0, 0, 0, 0};
+
+  if (id >= 0 && id < sprites->spriteCount) {
+    spriteRect.x = sprites->sprites[id].x;
+    spriteRect.y = sprites->sprites[id].y;
+    spriteRect.w = sprites->sprites[id].width;
+    spriteRect.h = sprites->sprites[id].height;
+  }
 
   return spriteRect;
 }
 
-bool parseXML(const char *fileName, Sprite *spriteList) {
-  bool success = false;
+SDL_Texture *spriteTexture(SpriteRegistry *sprites, int id) {
+  if (id < 0 || id >= sprites->spriteCount)
+    return NULL;
+
+  return sprites->atlases[sprites->sprites[id].atlas];
+}
+
+SDL_FRect getSpriteRect(SpriteRegistry *sprites, const char *spriteName) {
+  return spriteRect(sprites, spriteFind(sprites, spriteName));
+}
+
+bool parseXML(const char *fileName, SpriteRegistry *sprites,
+              SDL_Renderer *gRenderer) /* Load one TextureAtlas */
+{
   xmlDoc *spriteXML = xmlReadFile(fileName, NULL, 0);
   if (spriteXML == NULL) {
     printf("'%s' could not be loaded!\n", fileName);
-    success = false;
+    return false;
   }
 
   xmlNode *root = xmlDocGetRootElement(spriteXML);
-  xmlNode *curNode = root->children;
-  int spriteNum = 0;
+  xmlChar *imagePath =
+      root != NULL ? xmlGetProp(root, (const xmlChar *)"imagePath") : NULL;
+  if (imagePath == NULL) {
+    printf("'%s' has no TextureAtlas imagePath!\n", fileName);
+    xmlFreeDoc(spriteXML);
+    return false;
+  }
 
+  /* imagePath is relative to the xml file */
+  char texturePath[256];
+  const char *dirEnd = strrchr(fileName, '/');
+  int dirLength = dirEnd != NULL ? dirEnd - fileName + 1 : 0;
+  snprintf(texturePath, sizeof(texturePath), "%.*s%s", dirLength, fileName,
+           (char *)imagePath);
+  xmlFree(imagePath);
+
+  SDL_Texture *atlas = textureLoad(gRenderer, texturePath);
+  SDL_Texture **atlases =
+      atlas != NULL ? realloc(sprites->atlases,
+                              (sprites->atlasCount + 1) * sizeof(SDL_Texture *))
+                    : NULL;
+  if (atlases == NULL) {
+    printf("'%s' could not be loaded! SDL_image Error: %s\n", texturePath,
+           SDL_GetError());
+    SDL_DestroyTexture(atlas);
+    xmlFreeDoc(spriteXML);
+    return false;
+  }
+  sprites->atlases = atlases;
+  int atlasNum = sprites->atlasCount++;
+  sprites->atlases[atlasNum] = atlas;
+
+  xmlNode *curNode = root->children;
   while (curNode != NULL) {
     if (curNode->type == XML_ELEMENT_NODE) {
-      Sprite *sprite = &spriteList[spriteNum];
+      Sprite sprite;
 
       xmlChar *name = xmlGetProp(curNode, (const xmlChar *)"name");
       xmlChar *x = xmlGetProp(curNode, (const xmlChar *)"x");
@@ -42,23 +182,26 @@ bool parseXML(const char *fileName, Sprite *spriteList) {
       xmlChar *width = xmlGetProp(curNode, (const xmlChar *)"width");
       xmlChar *height = xmlGetProp(curNode, (const xmlChar *)"height");
 
-      snprintf(sprite->name, sizeof(sprite->name), "%s", name);
-      sprite->x = atoi((char *)x);
-      sprite->y = atoi((char *)y);
-      sprite->width = atoi((char *)width);
-      sprite->height = atoi((char *)height);
+      if (name != NULL && x != NULL && y != NULL && width != NULL &&
+          height != NULL) {
+        snprintf(sprite.name, sizeof(sprite.name), "%s", name);
+        sprite.x = atoi((char *)x);
+        sprite.y = atoi((char *)y);
+        sprite.width = atoi((char *)width);
+        sprite.height = atoi((char *)height);
+        sprite.atlas = atlasNum;
+        spriteAdd(sprites, &sprite);
+      }
 
       xmlFree(name);
       xmlFree(x);
       xmlFree(y);
       xmlFree(width);
       xmlFree(height);
-
-      spriteNum++;
     }
     curNode = curNode->next;
   }
   xmlFreeDoc(spriteXML);
 
-  return success;
+  return true;
 }
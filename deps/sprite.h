@@ -6,9 +6,31 @@
 typedef struct Sprite {
   char name[50];
   int width, height, x, y;
+  int atlas; /* Index into SpriteRegistry.atlases */
 } Sprite;
 
-SDL_FRect getSpriteRect(Sprite *spriteList, const char *spriteName); 
-bool parseXML(const char *fileName, Sprite *spriteList); 
+/* Every atlas loaded so far. Sprite IDs index sprites[] and never change,
+ * names map to IDs through an open addressing hash table */
+typedef struct SpriteRegistry {
+  Sprite *sprites;
+  int spriteCount;
+  int spriteCapacity;
+
+  int *slots; /* Sprite ID or -1 */
+  int slotCount; /* Power of 2 */
+
+  SDL_Texture **atlases;
+  int atlasCount;
+} SpriteRegistry;
+
+void spriteRegistryInit(SpriteRegistry *sprites);
+void spriteRegistryDestroy(SpriteRegistry *sprites);
+int spriteAdd(SpriteRegistry *sprites, const Sprite *sprite);
+int spriteFind(SpriteRegistry *sprites, const char *spriteName);
+SDL_FRect spriteRect(SpriteRegistry *sprites, int id);
+SDL_Texture *spriteTexture(SpriteRegistry *sprites, int id);
+SDL_FRect getSpriteRect(SpriteRegistry *sprites, const char *spriteName);
+bool parseXML(const char *fileName, SpriteRegistry *sprites,
+              SDL_Renderer *gRenderer);
 
 #endif //SPRITE_H_
@@ -0,0 +1,147 @@
+#include "texture.h"
+#include "includes.h"
+#include "objects.h"
+
+Uint64 textureHash(const void *data, size_t size) /* FNV-1a */
+{
+  const unsigned char *bytes = data;
+  Uint64 hash = 0xcbf29ce484222325ULL;
+
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+
+  return hash;
+}
+
+static SDL_PixelFormat textureTargetFormat(SDL_Renderer *gRenderer) {
+  const SDL_PixelFormat *formats = SDL_GetPointerProperty(
+      SDL_GetRendererProperties(gRenderer),
+      SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, NULL);
+
+  /* First format is the renderer's native one */
+  if (formats != NULL && formats[0] != SDL_PIXELFORMAT_UNKNOWN)
+    return formats[0];
+  return SDL_PIXELFORMAT_ARGB8888;
+}
+
+static void textureCachePath(char *cachePath, size_t size,
+                             const char *fileName) {
+  char flatName[200];
+  snprintf(flatName, sizeof(flatName), "%s", fileName);
+  for (char *c = flatName; *c != '\0'; c++)
+    if (*c == '/' || *c == '\\')
+      *c = '_';
+
+  snprintf(cachePath, size, "%s/%s.tex", TEXTURE_CACHE_DIR, flatName);
+}
+
+static SDL_Texture *textureCreate(SDL_Renderer *gRenderer,
+                                  SDL_PixelFormat format, int width,
+                                  int height, const void *pixels, int pitch) {
+  SDL_Texture *texture = SDL_CreateTexture(
+      gRenderer, format, SDL_TEXTUREACCESS_STATIC, width, height);
+  if (texture == NULL)
+    return NULL;
+
+  if (!SDL_UpdateTexture(texture, NULL, pixels, pitch)) {
+    SDL_DestroyTexture(texture);
+    return NULL;
+  }
+
+  /* Matches what SDL_CreateTextureFromSurface would have picked */
+  if (SDL_ISPIXELFORMAT_ALPHA(format))
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+  return texture;
+}
+
+static bool textureCacheSave(const char *cachePath, TextureCacheHeader *header,
+                             SDL_Surface *surface) {
+  SDL_CreateDirectory(TEXTURE_CACHE_DIR);
+
+  FILE *cacheFile = fopen(cachePath, "wb");
+  if (cacheFile == NULL)
+    return false;
+
+  bool success = fwrite(header, sizeof(*header), 1, cacheFile) == 1;
+  const unsigned char *row = surface->pixels;
+  for (int y = 0; y < surface->h && success; y++)
+    success = fwrite(row + (size_t)y * surface->pitch, header->pitch, 1,
+                     cacheFile) == 1;
+  fclose(cacheFile);
+
+  if (!success) /* Don't leave a torn cache file behind */
+    remove(cachePath);
+
+  return success;
+}
+
+SDL_Texture *textureLoad(SDL_Renderer *gRenderer,
+                         const char *fileName) /* Load an image through the
+                                                  converted pixel cache */
+{
+  size_t sourceSize;
+  void *source = SDL_LoadFile(fileName, &sourceSize);
+  if (source == NULL)
+    return NULL;
+
+  TextureCacheHeader header;
+  header.magic = TEXTURE_CACHE_MAGIC;
+  header.version = TEXTURE_CACHE_VERSION;
+  header.sourceHash = textureHash(source, sourceSize);
+  header.format = textureTargetFormat(gRenderer);
+
+  char cachePath[256];
+  textureCachePath(cachePath, sizeof(cachePath), fileName);
+
+  /* Hit -> One read and an upload, no decode or conversion */
+  size_t cacheSize;
+  unsigned char *cache = SDL_LoadFile(cachePath, &cacheSize);
+  if (cache != NULL && cacheSize >= sizeof(TextureCacheHeader)) {
+    TextureCacheHeader *cached = (TextureCacheHeader *)cache;
+    if (cached->magic == header.magic && cached->version == header.version &&
+        cached->sourceHash == header.sourceHash &&
+        cached->format == header.format && cached->width > 0 &&
+        cached->height > 0 &&
+        cacheSize == sizeof(TextureCacheHeader) +
+                         (size_t)cached->pitch * cached->height) {
+      SDL_Texture *texture = textureCreate(
+          gRenderer, cached->format, cached->width, cached->height,
+          cache + sizeof(TextureCacheHeader), cached->pitch);
+      SDL_free(cache);
+      if (texture != NULL) {
+        SDL_free(source);
+        return texture;
+      }
+      cache = NULL;
+    }
+  }
+  SDL_free(cache);
+
+  /* Miss or stale -> Decode, convert and refresh the cache */
+  SDL_Surface *decoded =
+      IMG_Load_IO(SDL_IOFromConstMem(source, sourceSize), true);
+  SDL_free(source);
+  if (decoded == NULL)
+    return NULL;
+
+  SDL_Surface *converted = SDL_ConvertSurface(decoded, header.format);
+  SDL_DestroySurface(decoded);
+  if (converted == NULL)
+    return NULL;
+
+  header.width = converted->w;
+  header.height = converted->h;
+  header.pitch = converted->w * SDL_BYTESPERPIXEL(header.format);
+
+  SDL_Texture *texture =
+      textureCreate(gRenderer, header.format, converted->w, converted->h,
+                    converted->pixels, converted->pitch);
+  if (texture != NULL && !textureCacheSave(cachePath, &header, converted))
+    printf("'%s' could not be written to the texture cache.\n", fileName);
+
+  SDL_DestroySurface(converted);
+  return texture;
+}
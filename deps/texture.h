@@ -0,0 +1,24 @@
+#ifndef TEXTURE_H_
+#define TEXTURE_H_
+
+#include "includes.h"
+
+#define TEXTURE_CACHE_DIR "Cache"
+#define TEXTURE_CACHE_MAGIC 0x58543150 /* "P1TX" */
+#define TEXTURE_CACHE_VERSION 1
+
+/* On-disk header, followed by height * pitch bytes of converted pixels */
+typedef struct TextureCacheHeader {
+  Uint32 magic;
+  Uint32 version;
+  Uint64 sourceHash; /* FNV-1a of the source image file */
+  Uint32 format;     /* SDL_PixelFormat the pixels were converted to */
+  Sint32 width;
+  Sint32 height;
+  Sint32 pitch;
+} TextureCacheHeader;
+
+Uint64 textureHash(const void *data, size_t size);
+SDL_Texture *textureLoad(SDL_Renderer *gRenderer, const char *fileName);
+
+#endif // TEXTURE_H_
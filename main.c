@@ -2,6 +2,24 @@
 #include "deps/objects.h"
 
 int main(int argc, char *args[]) {
+  Profiler profiler;
+  profilerInit(&profiler);
+
+  bool profileStartup = false; /* Print and save startup phase timings */
+  bool startupExit = false;    /* Quit once the first menu frame is shown */
+  int benchRuns = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(args[i], "--profile-startup") == 0)
+      profileStartup = true;
+    else if (strcmp(args[i], "--startup-exit") == 0)
+      startupExit = true;
+    else if (strcmp(args[i], "--bench-startup") == 0 && i + 1 < argc)
+      benchRuns = atoi(args[++i]);
+  }
+
+  if (benchRuns > 0) /* Relaunches itself benchRuns times */
+    return profileBenchStartup(args[0], benchRuns) ? 0 : 1;
+
   enum State gameState = MENU;
 
   SDL_Window *gWindow = NULL;
@@ -14,10 +32,11 @@ int main(int argc, char *args[]) {
   SDL_Texture *pauseBack = NULL;
   SDL_Texture *overBack = NULL;
 
-  SDL_Texture *spriteSheet = NULL;
+  SpriteRegistry sprites;
+  spriteRegistryInit(&sprites);
 
-  TTF_Font *kenVectorFont = NULL;
   TTF_TextEngine *gTextEngine = NULL;
+  FontCache fontCache = {};
 
   Mix_Music *bgMusic = NULL;
   Mix_Music *battleMusic = NULL;
@@ -28,17 +47,28 @@ int main(int argc, char *args[]) {
   Mix_Chunk *shieldUpSfx = NULL;
   Mix_Chunk *shieldDownSfx = NULL;
   Mix_Chunk *astDestroySfx = NULL;
+  SoundBank soundBank = {};
 
-  Sprite spriteList[SPRITEMAX] = {};
-  bool run = false;
+  Leaderboard leaderboard = {};
 
-  if (init(&gWindow, &gRenderer, &gTextEngine, &kenVectorFont)) /* Initialize */
-    if (load(gRenderer, spriteList, &menuBack1, &menuBack2, &gameBack,
-             &pauseBack, &overBack, &scoreBack, &spriteSheet, &bgMusic,
-             &battleMusic, &shootSfx, &shieldUpSfx, &shieldDownSfx,
-             &astDestroySfx, &loseSfx, &selectSfx)) /* Load Assets */
+  bool run = false;
+  bool firstFrame = true;
+
+  if (init(&gWindow, &gRenderer, &gTextEngine, &fontCache,
+           &profiler)) /* Initialize */
+    if (load(gRenderer, &sprites, &menuBack1, &menuBack2, &gameBack,
+             &pauseBack, &overBack, &scoreBack, &bgMusic, &battleMusic,
+             &shootSfx, &shieldUpSfx, &shieldDownSfx, &astDestroySfx, &loseSfx,
+             &selectSfx, &soundBank, &profiler)) /* Load Assets */
       run = true;
 
+  profileMark(&profiler, "Leaderboard");
+  if (run) /* Missing scores aren't fatal, they just won't be saved */
+    leaderboardOpen(&leaderboard, LEADERBOARD_FILE, LEADERBOARD_JOURNAL_FILE,
+                    LEADERBOARD_INDEX_FILE, LEADERBOARD_LEGACY_FILE);
+
+  profileMark(&profiler, "First Menu Frame");
+
   while (run) {
     if (gameState == MENU) /* Main Menu */
     {
@@ -133,8 +163,23 @@ int main(int argc, char *args[]) {
         if (f2PosX > WIDTH)
           f2PosX = 0;
 
-        drawMenu(gRenderer, gTextEngine, buttons, f1PosX, f2PosX, menuBack1,
-                 menuBack2, kenVectorFont);
+        leaderboardPoll(&leaderboard); /* Picks up finished compactions */
+        drawMenu(gRenderer, &fontCache, buttons, f1PosX, f2PosX, menuBack1,
+                 menuBack2);
+
+        if (firstFrame) /* Startup ends at the first presented frame */
+        {
+          firstFrame = false;
+          profileStop(&profiler);
+          if (profileStartup) {
+            profilePrint(&profiler);
+            profileSave(&profiler, PROFILE_FILE);
+          }
+          if (startupExit) {
+            exited = true;
+            run = false;
+          }
+        }
       }
     }
 
@@ -193,10 +238,10 @@ int main(int argc, char *args[]) {
 
         playerMovementHandler(&player, dTimer.delta);
         playerBulletHander(&player, dTimer.delta, shootSfx);
-        playerPowerUpHandler(&player, &powerUps, spriteSheet, spriteList,
-                             shieldUpSfx, shieldDownSfx);
+        playerPowerUpHandler(&player, &powerUps, &sprites, shieldUpSfx,
+                             shieldDownSfx);
         asteroidHandler(&asteroids, &powerUps, &player, &astSpawnTimer,
-                        &astSpawnCount, astSpawnTime, dTimer.delta, spriteList,
+                        &astSpawnCount, astSpawnTime, dTimer.delta, &sprites,
                         astDestroySfx);
         if (astSpawnCount > 10 && astSpawnCount < 500 && astSpawnTime > 500)
           astSpawnTime -= 100;
@@ -234,20 +279,23 @@ int main(int argc, char *args[]) {
 
           SDL_DestroyTexture(player.icon);
 
-          TTF_SetFontSize(kenVectorFont, 3 * HEIGHT / 50.f);
           char *tempText;
           SDL_asprintf(
               &tempText,
               "You destroyed %li asteroids \nin %i minutes and %i seconds",
               player.score, (player.gameTimer.ticks / 1000) / 60,
               (player.gameTimer.ticks / 1000) % 60);
-          free(tempText);
           TTF_Text *texts[3] = {};
-          texts[0] = TTF_CreateText(gTextEngine, kenVectorFont, tempText, 0);
+          texts[0] = TTF_CreateText(gTextEngine, fontCache.fonts[LARGEFONT],
+                                    tempText, 0);
+          free(tempText);
+          texts[1] =
+              TTF_CreateText(gTextEngine, fontCache.fonts[LARGEFONT], "", 0);
           tempText =
               "Type the username. Press Escape to not save the score. Press "
               "Enter to save the score.\n(Empty Username won't be stored!)";
-          texts[2] = TTF_CreateText(gTextEngine, kenVectorFont, tempText, 0);
+          texts[2] = TTF_CreateText(gTextEngine, fontCache.fonts[SMALLFONT],
+                                    tempText, 0);
 
           Button buttons[2];
 
@@ -309,8 +357,7 @@ int main(int argc, char *args[]) {
                 }
               }
             }
-            texts[1] =
-                TTF_CreateText(gTextEngine, kenVectorFont, playerName, 0);
+            TTF_SetTextString(texts[1], playerName, 0);
 
             for (int i = 0; i < 2; i++) {
               buttonStateUpdater(&buttons[i], selectSfx);
@@ -332,18 +379,19 @@ int main(int argc, char *args[]) {
               TTF_DestroyText(texts[2]);
 
               if (strcmp(playerName, "") != 0) {
-                char *jsonData = extractScores("scores.json");
-                jsonData = updateScores(jsonData, playerName, player.score,
-                                        player.gameTimer.ticks / 1000);
-                saveScores(jsonData, "scores.json");
+                ScoreRecord record = {};
+                snprintf(record.username, sizeof(record.username), "%s",
+                         playerName);
+                record.score = player.score;
+                record.time = player.gameTimer.ticks / 1000;
+                SDL_GetCurrentTime(&record.timestamp);
+                leaderboardAppend(&leaderboard, &record);
               }
 
-              TTF_SetFontSize(kenVectorFont, HEIGHT / 50.f);
               break;
             }
 
-            drawOver(gRenderer, gTextEngine, buttons, texts, overBack,
-                     kenVectorFont);
+            drawOver(gRenderer, &fontCache, buttons, texts, overBack);
           }
         } else if (gameState == PAUSED) {
           Mix_PauseMusic();
@@ -415,8 +463,7 @@ int main(int argc, char *args[]) {
               break;
             }
 
-            drawPaused(gRenderer, gTextEngine, buttons, pauseBack,
-                       kenVectorFont);
+            drawPaused(gRenderer, &fontCache, buttons, pauseBack);
           }
         }
 
@@ -426,13 +473,13 @@ int main(int argc, char *args[]) {
 
         char *fpsStr;
         SDL_asprintf(&fpsStr, "%f", 1 / fps);
-        TTF_Text *fpsText =
-            TTF_CreateText(gTextEngine, kenVectorFont, fpsStr, 0);
+        TTF_Text *fpsText = TTF_CreateText(
+            gTextEngine, fontCache.fonts[SMALLFONT], fpsStr, 0);
         free(fpsStr);
 
-        drawGame(gRenderer, gTextEngine, &player, &asteroids, &powerUps,
-                 fpsText, gameBack, spriteSheet, spriteList,
-                 kenVectorFont); /* Draw, Blit and Render */
+        leaderboardPoll(&leaderboard);
+        drawGame(gRenderer, &fontCache, &player, &asteroids, &powerUps,
+                 fpsText, gameBack, &sprites); /* Draw, Blit and Render */
 
         TTF_DestroyText(fpsText);
         frameEnd = SDL_GetPerformanceCounter();
@@ -441,10 +488,10 @@ int main(int argc, char *args[]) {
     }
 
     else if (gameState == SCORES) {
-      Button buttons[2];
+      Button buttons[3];
 
-      buttons[0].text =
-          TTF_CreateText(gTextEngine, kenVectorFont, "Sort By Score", 0);
+      buttons[0].text = TTF_CreateText(gTextEngine, fontCache.fonts[SMALLFONT],
+                                       "Sort By Score", 0);
       buttons[0].clicked = 0;
       buttons[0].hovered = 0;
       buttons[0].width = 200;
@@ -458,7 +505,8 @@ int main(int argc, char *args[]) {
       Timer buttonTimer = timerInit();
       timerStart(&buttonTimer);
 
-      buttons[1].text = TTF_CreateText(gTextEngine, kenVectorFont, "Search", 0);
+      buttons[1].text = TTF_CreateText(gTextEngine, fontCache.fonts[SMALLFONT],
+                                       "Search", 0);
       buttons[1].clicked = 0;
       buttons[1].hovered = 0;
       buttons[1].width = 200;
@@ -470,38 +518,38 @@ int main(int argc, char *args[]) {
       buttons[1].rect.x = buttons[1].posX;
       buttons[1].rect.y = buttons[1].posY;
 
-      char *jsonData = extractScores("scores.json"); /* Grab Data */
-      enum Sort sortType = SCORE;
-      cJSON *root = NULL;
-      cJSON *scoreArr = NULL;
-      if (jsonData == NULL) /* Doesn't Exist -> Create New */
-      {
-        root = cJSON_CreateObject();
-        scoreArr = cJSON_CreateArray();
-        cJSON_AddItemToObject(root, "Scores", scoreArr);
-      } else /* Exist -> Use Existing*/
-      {
-        root = cJSON_Parse(jsonData);
-        sortScores(root, sortType);
-        scoreArr = cJSON_GetObjectItem(root, "Scores");
-      }
-
-      free(jsonData);
-
-      int arrSize = cJSON_GetArraySize(scoreArr);
-      ScoreObj scores[8]; /* 8 Scores At A Time */
-      int scoreCursor = 0;
+      buttons[2].text = TTF_CreateText(gTextEngine, fontCache.fonts[SMALLFONT],
+                                       "Players", 0);
+      buttons[2].clicked = 0;
+      buttons[2].hovered = 0;
+      buttons[2].width = 200;
+      buttons[2].height = 50;
+      buttons[2].posX = buttons[0].posX + buttons[0].width + 10;
+      buttons[2].posY = 1 * HEIGHT / 11.f - buttons[2].height / 2.f;
+      buttons[2].rect.w = buttons[2].width;
+      buttons[2].rect.h = buttons[2].height;
+      buttons[2].rect.x = buttons[2].posX;
+      buttons[2].rect.y = buttons[2].posY;
+
+      enum Sort sortType = SCORE; /* Picks which index the rows come from */
+      ScoreView view; /* Only the rows around the visible page */
+      scoreViewInit(&view, gTextEngine, fontCache.fonts[LARGEFONT]);
       TTF_Text *texts[4] = {};
 
-      char tempText[] = "Enter Username to get Scores. Leave empty to get all.";
-      texts[0] = TTF_CreateText(gTextEngine, kenVectorFont, tempText, 0);
-      texts[2] = TTF_CreateText(gTextEngine, kenVectorFont,
+      char tempText[] = "Type a username to filter the scores or #rank to "
+                        "jump to it. Leave empty to get all.";
+      texts[0] =
+          TTF_CreateText(gTextEngine, fontCache.fonts[SMALLFONT], tempText, 0);
+      texts[1] = TTF_CreateText(gTextEngine, fontCache.fonts[LARGEFONT], "", 0);
+      texts[2] = TTF_CreateText(gTextEngine, fontCache.fonts[SMALLFONT],
                                 "Press Esc to go back to menu", 0);
       texts[3] = NULL;
 
       char username[50] = {};
       int nameCursor = 0;
       bool textInput = false;
+      LeaderboardQuery query = {};
+      bool searchChanged = false; /* Filter again before drawing */
 
       SDL_Event e;
       bool exited = false;
@@ -517,39 +565,61 @@ int main(int argc, char *args[]) {
                    nameCursor < sizeof(username) - 1) {
             SDL_strlcat(username, e.text.text, sizeof(username));
             nameCursor = strlen(username);
+            searchChanged = true;
           }
 
           else if (e.type == SDL_EVENT_KEY_DOWN && textInput) {
             if (e.key.key == SDLK_RETURN || e.key.key == SDLK_ESCAPE) {
-              if (e.key.key == SDLK_ESCAPE)
+              if (e.key.key == SDLK_ESCAPE) {
                 strcpy(username, "");
+                nameCursor = 0;
+                searchChanged = true;
+              }
               SDL_StopTextInput(gWindow);
               textInput = false;
-              texts[1] =
-                  TTF_CreateText(gTextEngine, kenVectorFont, username, 0);
+              TTF_DestroyText(texts[3]);
               texts[3] = NULL;
             } else if (e.key.key == SDLK_BACKSPACE && nameCursor > 0) {
               nameCursor--;
               username[nameCursor] = '\0';
+              searchChanged = true;
             }
           }
 
-          else if (e.type == SDL_EVENT_KEY_DOWN && e.key.repeat == 0) {
-            if (e.key.key == SDLK_ESCAPE)
+          else if (e.type == SDL_EVENT_KEY_DOWN) /* Repeats scroll too */
+          {
+            if (e.key.key == SDLK_ESCAPE && e.key.repeat == 0)
               gameState = MENU;
+            else if (e.key.key == SDLK_UP)
+              scoreViewScroll(&view, -1);
+            else if (e.key.key == SDLK_DOWN)
+              scoreViewScroll(&view, 1);
+            else if (e.key.key == SDLK_PAGEUP)
+              scoreViewScroll(&view, -VIEW_ROWS);
+            else if (e.key.key == SDLK_PAGEDOWN)
+              scoreViewScroll(&view, VIEW_ROWS);
+            else if (e.key.key == SDLK_HOME)
+              scoreViewJump(&view, 0);
+            else if (e.key.key == SDLK_END)
+              scoreViewJump(&view, view.rowCount);
           }
 
-          else if (e.type == SDL_EVENT_MOUSE_WHEEL && !textInput) {
-            if (!(scoreCursor - (int)e.wheel.y < 0) &&
-                !(scoreCursor - (int)e.wheel.y >
-                  arrSize - 8 /* Number of Scores on Screen*/))
-              scoreCursor -= (int)e.wheel.y;
-          }
+          else if (e.type == SDL_EVENT_MOUSE_WHEEL && !textInput)
+            scoreViewScroll(&view, -(int)e.wheel.y);
+        }
+        if (searchChanged) /* Results follow every keystroke */
+        {
+          searchChanged = false;
+          TTF_SetTextString(texts[1], username, 0);
+          scoreViewReset(&view);
+          if (username[0] == '#') /* Jump instead of filtering */
+            scoreViewJump(&view, SDL_max(atoi(username + 1) - 1, 0));
+          else if (username[0] != '\0')
+            leaderboardQuery(&leaderboard, &query, username);
         }
-        if (textInput)
-          texts[1] = TTF_CreateText(gTextEngine, kenVectorFont, username, 0);
-        else {
-          for (int i = 0; i < 2; i++) {
+
+        if (!textInput) {
+          for (int i = 0; i < 3; i++) {
             buttonStateUpdater(&buttons[i], selectSfx);
           }
 
@@ -557,112 +627,77 @@ int main(int argc, char *args[]) {
             if (sortType == SCORE) /* Cycle through sort types */
             {
               sortType = TIME;
-              buttons[0].text =
-                  TTF_CreateText(gTextEngine, kenVectorFont, "Sort By Time", 0);
+              TTF_SetTextString(buttons[0].text, "Sort By Time", 0);
             } else if (sortType == TIME) {
               sortType = NAME;
-              buttons[0].text =
-                  TTF_CreateText(gTextEngine, kenVectorFont, "Sort By Name", 0);
+              TTF_SetTextString(buttons[0].text, "Sort By Name", 0);
             } else if (sortType == NAME) {
               sortType = SCORE;
-              buttons[0].text = TTF_CreateText(gTextEngine, kenVectorFont,
-                                               "Sort By Score", 0);
+              TTF_SetTextString(buttons[0].text, "Sort By Score", 0);
             }
-            sortScores(root, sortType);
-            scoreArr = cJSON_GetObjectItem(root, "Scores"); /* Regrab array */
+            timerReset(&buttonTimer);
+          }
+
+          if (buttons[2].clicked && buttonTimer.ticks > 200) {
+            scoreViewSetPlayers(&view, !view.players); /* Scores <-> Totals */
+            TTF_SetTextString(buttons[2].text,
+                              view.players ? "Scores" : "Players", 0);
             timerReset(&buttonTimer);
           }
 
           if (buttons[1].clicked) {
-            texts[3] = TTF_CreateText(gTextEngine, kenVectorFont, "!", 0);
+            texts[3] = TTF_CreateText(gTextEngine, fontCache.fonts[SMALLFONT],
+                                      "!", 0);
             textInput = true;
             SDL_StartTextInput(gWindow);
           }
-
-          if (username[0] == '\0') {
-            for (int i = 0; i < 8; i++) {
-              cJSON *jScoreObj = cJSON_GetArrayItem(scoreArr, scoreCursor + i);
-              if (jScoreObj != NULL) {
-                cJSON *jUsername = cJSON_GetObjectItem(jScoreObj, "Username");
-                char *userName = jUsername->valuestring;
-                cJSON *jScore = cJSON_GetObjectItem(jScoreObj, "Score");
-                int score = jScore->valueint;
-                cJSON *jTime = cJSON_GetObjectItem(jScoreObj, "Time");
-                int time = jTime->valueint;
-                strcpy(scores[i].username, userName);
-                scores[i].score = score;
-                scores[i].time = time;
-              } else {
-                strcpy(scores[i].username, "");
-                scores[i].score = 0;
-                scores[i].time = 0;
-              }
-            }
-          } else {
-            cJSON *userArr = cJSON_CreateArray();
-            cJSON *userScore = NULL;
-            int arrSize = cJSON_GetArraySize(scoreArr);
-            for (int i = 0; i < arrSize; i++) {
-              userScore = cJSON_GetArrayItem(scoreArr, i);
-              if (strncmp(
-                      cJSON_GetObjectItem(userScore, "Username")->valuestring,
-                      username, 50) == 0)
-                cJSON_AddItemReferenceToArray(userArr, userScore);
-            }
-
-            for (int i = 0; i < 8; i++) {
-              cJSON *jScoreObj = cJSON_GetArrayItem(userArr, scoreCursor + i);
-              if (jScoreObj != NULL) {
-                cJSON *jUsername = cJSON_GetObjectItem(jScoreObj, "Username");
-                char *userName = jUsername->valuestring;
-                cJSON *jScore = cJSON_GetObjectItem(jScoreObj, "Score");
-                int score = jScore->valueint;
-                cJSON *jTime = cJSON_GetObjectItem(jScoreObj, "Time");
-                int time = jTime->valueint;
-                strcpy(scores[i].username, userName);
-                scores[i].score = score;
-                scores[i].time = time;
-              } else {
-                strcpy(scores[i].username, "");
-                scores[i].score = 0;
-                scores[i].time = 0;
-              }
-            }
-          }
         }
 
+        /* Filtered -> Matches of the typed prefix in sortType order */
+        bool filtered = username[0] != '\0' && username[0] != '#';
+        scoreViewUpdate(&view, &leaderboard, filtered ? &query : NULL,
+                        sortType);
+
         if (gameState != SCORES) {
           TTF_DestroyText(texts[0]);
           TTF_DestroyText(texts[1]);
           TTF_DestroyText(texts[2]);
           TTF_DestroyText(texts[3]);
-          TTF_SetFontSize(kenVectorFont, HEIGHT / 50.f);
+          TTF_DestroyText(buttons[0].text);
+          TTF_DestroyText(buttons[1].text);
+          TTF_DestroyText(buttons[2].text);
+          leaderboardQueryFree(&query);
+          scoreViewDestroy(&view);
           break;
         }
 
         timerCalcTicks(&buttonTimer);
-        drawScores(gRenderer, gTextEngine, buttons, texts, scores, scoreBack,
-                   kenVectorFont);
+        leaderboardPoll(&leaderboard);
+        drawScores(gRenderer, &fontCache, buttons, texts, &view, scoreBack);
       }
     }
   }
 
   // Quit Protocols
+  leaderboardClose(&leaderboard);
+
   Mix_FreeChunk(loseSfx);
   Mix_FreeChunk(shieldDownSfx);
   Mix_FreeChunk(shieldUpSfx);
   Mix_FreeChunk(astDestroySfx);
   Mix_FreeChunk(shootSfx);
   Mix_FreeChunk(selectSfx);
+  soundBankClose(&soundBank); /* After the chunks that point into it */
   Mix_FreeMusic(battleMusic);
   Mix_FreeMusic(bgMusic);
   Mix_Quit();
 
+  fontCachePrint(&fontCache);
+  fontCacheDestroy(&fontCache); /* Texts go before their engine */
   TTF_DestroyRendererTextEngine(gTextEngine);
-  TTF_CloseFont(kenVectorFont);
   TTF_Quit();
 
-  SDL_DestroyTexture(spriteSheet);
+  spriteRegistryDestroy(&sprites);
   SDL_DestroyTexture(scoreBack);
   SDL_DestroyTexture(overBack);
   SDL_DestroyTexture(pauseBack);
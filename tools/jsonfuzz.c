@@ -0,0 +1,582 @@
+#include "../deps/includes.h"
+
+/* Fuzz: checks cJSON's fast paths against the code they stand in for.
+ * Generates random documents heavy in strings, escapes and whitespace, some
+ * of them truncated or corrupted, and parses, prints and streams each one at
+ * every SIMD level the CPU has. Any difference from cJSON_SimdNone is a
+ * mismatch, as is cJSON_ParseInsitu giving another tree than cJSON_Parse.
+ * Random numbers must parse to what strtod gives and print as the shortest
+ * "%.*g" that reads back as the same double, or as every digit for integers
+ * below 1e15. Objects with an index, changed at random, must find the same
+ * member a walk of their list does, and arrays the same items and size. The
+ * exit code is 1 if there was a mismatch
+ * Usage: jsonfuzz [--docs <count>] [--seed <number>] */
+
+#define FUZZ_DOCS 100000
+#define FUZZ_DEPTH 6
+#define FUZZ_MEMBERS 12 /* Most items per array or object */
+#define FUZZ_STRING_MAX 300 /* Past a few AVX2 blocks */
+#define FUZZ_CHUNK_MAX 64   /* Largest piece fed to the SAX parser */
+#define FUZZ_NUMBERS 16     /* Checked per document */
+#define FUZZ_INDEX_STEPS 64 /* Changes to an indexed object per document */
+
+typedef struct FuzzText {
+  char *data;
+  size_t length;
+  size_t capacity;
+} FuzzText;
+
+/* What one level made of a document */
+typedef struct FuzzResult {
+  bool parsed;
+  size_t end; /* Parse end or error offset */
+  char *compact;
+  char *formatted;
+  char *insitu; /* Compact print of the in-place parse */
+  bool streamed;
+  size_t saxOffset;
+  Uint64 saxHash; /* Over every event and its data */
+  char *printed;  /* The document's bytes as one string value */
+} FuzzResult;
+
+static Uint64 fuzzRandom(Uint64 *state) /* xorshift64* */
+{
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 2685821657736338717ull;
+}
+
+static bool fuzzPut(FuzzText *text, const char *bytes, size_t length) {
+  if (text->length + length + 1 > text->capacity) {
+    size_t capacity = text->capacity ? text->capacity * 2 : 256;
+    while (capacity < text->length + length + 1)
+      capacity *= 2;
+    char *data = realloc(text->data, capacity);
+    if (data == NULL)
+      return false;
+    text->data = data;
+    text->capacity = capacity;
+  }
+  memcpy(text->data + text->length, bytes, length);
+  text->length += length;
+  text->data[text->length] = '\0';
+  return true;
+}
+
+static void fuzzWhitespace(FuzzText *text, Uint64 *random) /* Anything <= 32
+                                                              is whitespace */
+{
+  static const char spaces[] = " \t\r\n";
+  Uint64 roll = fuzzRandom(random) % 8;
+  int length = roll < 4   ? 0
+               : roll < 7 ? fuzzRandom(random) % 8
+                          : 1 + fuzzRandom(random) % 80;
+
+  for (int i = 0; i < length; i++) {
+    char c = fuzzRandom(random) % 16 ? spaces[fuzzRandom(random) % 4]
+                                     : 1 + fuzzRandom(random) % 32;
+    fuzzPut(text, &c, 1);
+  }
+}
+
+static void fuzzString(FuzzText *text, Uint64 *random) {
+  static const char *escapes[] = {"\\\"", "\\\\", "\\/", "\\b", "\\f",
+                                  "\\n",  "\\r",  "\\t", "\\u00e9",
+                                  "\\u0001", "\\ud83d\\ude00", "\\x"};
+  int length = fuzzRandom(random) % 4 ? fuzzRandom(random) % 24
+                                      : fuzzRandom(random) % FUZZ_STRING_MAX;
+
+  fuzzPut(text, "\"", 1);
+  for (int i = 0; i < length; i++) {
+    Uint64 roll = fuzzRandom(random) % 64;
+    if (roll == 0) {
+      const char *escape = escapes[fuzzRandom(random) % SDL_arraysize(escapes)];
+      fuzzPut(text, escape, strlen(escape));
+    } else {
+      /* Raw control and high bytes are passed through by the parser */
+      char c = roll == 1   ? 1 + fuzzRandom(random) % 31
+               : roll == 2 ? 128 + fuzzRandom(random) % 128
+                           : 'a' + fuzzRandom(random) % 26;
+      fuzzPut(text, &c, 1);
+    }
+  }
+  fuzzPut(text, "\"", 1);
+}
+
+static void fuzzValue(FuzzText *text, Uint64 *random, int depth) {
+  static const char *scalars[] = {"0", "-12", "3.5e2", "true", "false",
+                                  "null"};
+  Uint64 roll = fuzzRandom(random) % (depth < FUZZ_DEPTH ? 8 : 5);
+
+  fuzzWhitespace(text, random);
+  if (roll < 3)
+    fuzzString(text, random);
+  else if (roll < 5) {
+    const char *scalar = scalars[fuzzRandom(random) % SDL_arraysize(scalars)];
+    fuzzPut(text, scalar, strlen(scalar));
+  } else {
+    bool object = roll == 7;
+    int count = fuzzRandom(random) % FUZZ_MEMBERS;
+    fuzzPut(text, object ? "{" : "[", 1);
+    for (int i = 0; i < count; i++) {
+      if (i > 0)
+        fuzzPut(text, ",", 1);
+      if (object) {
+        fuzzWhitespace(text, random);
+        fuzzString(text, random);
+        fuzzWhitespace(text, random);
+        fuzzPut(text, ":", 1);
+      }
+      fuzzValue(text, random, depth + 1);
+    }
+    fuzzWhitespace(text, random);
+    fuzzPut(text, object ? "}" : "]", 1);
+  }
+  fuzzWhitespace(text, random);
+}
+
+static void fuzzDocument(FuzzText *text, Uint64 *random) /* Some truncated or
+                                                            corrupted */
+{
+  static const char breakers[] = "\"\\ \n{}[],:u";
+  text->length = 0;
+  fuzzValue(text, random, 0);
+
+  Uint64 roll = fuzzRandom(random) % 8;
+  if (roll == 0 && text->length > 0)
+    text->length = fuzzRandom(random) % text->length;
+  else if (roll == 1 && text->length > 0)
+    for (int i = 0, flips = 1 + fuzzRandom(random) % 3; i < flips; i++)
+      text->data[fuzzRandom(random) % text->length] =
+          breakers[fuzzRandom(random) % (sizeof(breakers) - 1)];
+  text->data[text->length] = '\0';
+}
+
+/* SAX Events -> FNV-1a over each event's kind and data */
+
+static void saxMix(void *user, int kind, const void *data, size_t length) {
+  Uint64 *hash = user;
+  *hash = (*hash ^ (Uint64)kind) * 1099511628211ull;
+  for (size_t i = 0; i < length; i++)
+    *hash = (*hash ^ ((const unsigned char *)data)[i]) * 1099511628211ull;
+}
+
+static cJSON_bool saxStartObject(void *user) {
+  saxMix(user, 1, NULL, 0);
+  return true;
+}
+static cJSON_bool saxEndObject(void *user) {
+  saxMix(user, 2, NULL, 0);
+  return true;
+}
+static cJSON_bool saxStartArray(void *user) {
+  saxMix(user, 3, NULL, 0);
+  return true;
+}
+static cJSON_bool saxEndArray(void *user) {
+  saxMix(user, 4, NULL, 0);
+  return true;
+}
+static cJSON_bool saxKey(void *user, const char *key) {
+  saxMix(user, 5, key, strlen(key));
+  return true;
+}
+static cJSON_bool saxString(void *user, const char *value) {
+  saxMix(user, 6, value, strlen(value));
+  return true;
+}
+static cJSON_bool saxNumber(void *user, double value) {
+  saxMix(user, 7, &value, sizeof(value));
+  return true;
+}
+static cJSON_bool saxBoolean(void *user, cJSON_bool value) {
+  saxMix(user, 8, &value, sizeof(value));
+  return true;
+}
+static cJSON_bool saxNull(void *user) {
+  saxMix(user, 9, NULL, 0);
+  return true;
+}
+
+static const cJSON_SaxHandler saxHandler = {
+    saxStartObject, saxEndObject, saxStartArray, saxEndArray, saxKey,
+    saxString,      saxNumber,    saxBoolean,    saxNull};
+
+static void fuzzRun(const FuzzText *text, Uint64 chunkSeed,
+                    FuzzResult *result) {
+  const char *end = NULL;
+  memset(result, 0, sizeof(FuzzResult));
+
+  cJSON *root =
+      cJSON_ParseWithLengthOpts(text->data, text->length, &end, false);
+  result->parsed = root != NULL;
+  result->end = end != NULL ? (size_t)(end - text->data) : 0;
+  if (root != NULL) {
+    result->compact = cJSON_PrintUnformatted(root);
+    result->formatted = cJSON_Print(root);
+    cJSON_Delete(root);
+  }
+
+  char *copy = malloc(text->length + 1);
+  if (copy != NULL) {
+    memcpy(copy, text->data, text->length);
+    root = cJSON_ParseInsituWithLength(copy, text->length);
+    if (root != NULL) {
+      result->insitu = cJSON_PrintUnformatted(root);
+      cJSON_Delete(root);
+    }
+    free(copy);
+  }
+
+  /* Same chunking at every level, so buffered strings split the same way */
+  result->saxHash = 14695981039346656037ull;
+  cJSON_Sax *sax = cJSON_SaxCreate(&saxHandler, &result->saxHash);
+  if (sax != NULL) {
+    bool success = true;
+    for (size_t offset = 0; success && offset < text->length;) {
+      size_t chunk = 1 + fuzzRandom(&chunkSeed) % FUZZ_CHUNK_MAX;
+      chunk = SDL_min(chunk, text->length - offset);
+      success = cJSON_SaxFeed(sax, text->data + offset, chunk);
+      offset += chunk;
+    }
+    result->streamed = success && cJSON_SaxFinish(sax);
+    result->saxOffset = cJSON_SaxOffset(sax);
+    cJSON_SaxDelete(sax);
+  }
+
+  cJSON *string = cJSON_CreateString(text->data);
+  if (string != NULL) {
+    result->printed = cJSON_PrintUnformatted(string);
+    cJSON_Delete(string);
+  }
+}
+
+static bool fuzzSame(const char *a, const char *b) {
+  return (a == NULL) == (b == NULL) && (a == NULL || strcmp(a, b) == 0);
+}
+
+static bool fuzzCompare(const FuzzResult *a, const FuzzResult *b) {
+  return a->parsed == b->parsed && a->end == b->end &&
+         fuzzSame(a->compact, b->compact) &&
+         fuzzSame(a->formatted, b->formatted) &&
+         fuzzSame(a->insitu, b->insitu) && a->streamed == b->streamed &&
+         a->saxOffset == b->saxOffset && a->saxHash == b->saxHash &&
+         fuzzSame(a->printed, b->printed);
+}
+
+static void fuzzFree(FuzzResult *result) {
+  cJSON_free(result->compact);
+  cJSON_free(result->formatted);
+  cJSON_free(result->insitu);
+  cJSON_free(result->printed);
+}
+
+/* Numbers -> Digits and exponents of any length, as JSON writes them */
+
+static void fuzzNumberText(char *number, Uint64 *random) {
+  char *digit = number;
+  if (fuzzRandom(random) % 2)
+    *digit++ = '-';
+  int count = 1 + fuzzRandom(random) % (fuzzRandom(random) % 4 ? 8 : 20);
+  *digit++ = '1' + fuzzRandom(random) % 9;
+  for (int i = 1; i < count; i++)
+    *digit++ = '0' + fuzzRandom(random) % 10;
+  if (fuzzRandom(random) % 2) {
+    *digit++ = '.';
+    count = 1 + fuzzRandom(random) % (fuzzRandom(random) % 4 ? 6 : 20);
+    for (int i = 0; i < count; i++)
+      *digit++ = '0' + fuzzRandom(random) % 10;
+  }
+  if (fuzzRandom(random) % 4 == 0)
+    digit += sprintf(digit, "e%i", (int)(fuzzRandom(random) % 80) - 40);
+  *digit = '\0';
+}
+
+static bool fuzzNumber(Uint64 *random) /* Parsed and printed */
+{
+  char number[64];
+  fuzzNumberText(number, random);
+  double expected = strtod(number, NULL);
+  cJSON *parsed = cJSON_Parse(number);
+  bool success = parsed != NULL && parsed->valuedouble == expected;
+  cJSON_Delete(parsed);
+
+  /* Any double, integral ones a third of the time */
+  double value;
+  Uint64 bits = fuzzRandom(random);
+  memcpy(&value, &bits, sizeof(value));
+  if (bits % 3 == 0)
+    value = (double)(Sint64)(fuzzRandom(random) % 2000000000000000ull) - 1e15;
+  if (SDL_isnan(value) || SDL_isinf(value))
+    return success;
+
+  /* Integers below 1e15 keep all their digits, as "%1.15g" printed them */
+  char shortest[32];
+  if (value == SDL_floor(value) && SDL_fabs(value) < 1e15)
+    sprintf(shortest, "%.0f", value == 0 ? 0.0 : value);
+  else
+    for (int precision = 1; precision <= 17; precision++) {
+      sprintf(shortest, "%.*g", precision, value);
+      if (strtod(shortest, NULL) == value)
+        break;
+    }
+
+  cJSON *item = cJSON_CreateNumber(value);
+  char *printed = cJSON_PrintUnformatted(item);
+  success = success && printed != NULL && strcmp(printed, shortest) == 0;
+  cJSON_free(printed);
+  cJSON_Delete(item);
+  return success;
+}
+
+/* Object Index -> Lookups against a walk of the list, keys differ in case */
+
+static void fuzzKey(char *key, Uint64 *random) {
+  sprintf(key, "%c%i", fuzzRandom(random) % 2 ? 'k' : 'K',
+          (int)(fuzzRandom(random) % 40));
+}
+
+static cJSON *fuzzMember(const char *key, double value) /* Keyed, unlinked */
+{
+  cJSON *holder = cJSON_CreateObject();
+  cJSON_AddNumberToObject(holder, key, value);
+  cJSON *member = cJSON_DetachItemFromArray(holder, 0);
+  cJSON_Delete(holder);
+  return member;
+}
+
+static cJSON *fuzzFind(const cJSON *object, const char *key,
+                       bool caseSensitive) {
+  for (cJSON *child = object->child; child != NULL; child = child->next)
+    if ((caseSensitive ? strcmp(child->string, key)
+                       : SDL_strcasecmp(child->string, key)) == 0)
+      return child;
+  return NULL;
+}
+
+static bool fuzzLookup(const cJSON *object, const char *key) {
+  return cJSON_GetObjectItem(object, key) == fuzzFind(object, key, false) &&
+         cJSON_GetObjectItemCaseSensitive(object, key) ==
+             fuzzFind(object, key, true);
+}
+
+static bool fuzzObjectIndex(Uint64 *random) /* Adds, inserts, detaches and
+                                               replaces members */
+{
+  cJSON *object = cJSON_CreateObject();
+  if (object == NULL)
+    return false;
+  char key[16];
+  for (int i = 0, count = fuzzRandom(random) % 48; i < count; i++) {
+    fuzzKey(key, random);
+    cJSON_AddNumberToObject(object, key, i);
+  }
+  bool success = cJSON_IndexObject(object);
+
+  for (int step = 0; success && step < FUZZ_INDEX_STEPS; step++) {
+    int size = cJSON_GetArraySize(object);
+    cJSON *member = NULL;
+    fuzzKey(key, random);
+    switch (fuzzRandom(random) % 10) {
+    case 0:
+      cJSON_AddNumberToObject(object, key, step);
+      break;
+    case 1:
+      cJSON_AddItemToObjectCS(object, "k5", cJSON_CreateNumber(step));
+      break;
+    case 2: /* Anywhere, past the end too */
+      member = fuzzMember(key, step);
+      if (!cJSON_InsertItemInArray(object, fuzzRandom(random) % (size + 2),
+                                   member))
+        cJSON_Delete(member);
+      break;
+    case 3:
+      cJSON_DeleteItemFromObject(object, key);
+      break;
+    case 4:
+      if (size > 0)
+        cJSON_Delete(
+            cJSON_DetachItemFromArray(object, fuzzRandom(random) % size));
+      break;
+    case 5:
+      member = cJSON_CreateString("replaced");
+      if (!cJSON_ReplaceItemInObject(object, key, member))
+        cJSON_Delete(member);
+      break;
+    case 6: /* Under another key */
+      if (size > 0)
+        cJSON_ReplaceItemViaPointer(
+            object, cJSON_GetArrayItem(object, fuzzRandom(random) % size),
+            fuzzMember(key, step));
+      break;
+    case 7:
+      success = cJSON_IndexObject(object);
+      break;
+    default:
+      success = fuzzLookup(object, key);
+    }
+  }
+
+  for (int i = 0; success && i < 40; i++) {
+    sprintf(key, "k%i", i);
+    success = fuzzLookup(object, key);
+  }
+  cJSON_Delete(object);
+  return success;
+}
+
+/* Array Index -> Items and size against a walk of the list */
+
+static int fuzzOrder(const void *a, const void *b) {
+  double x = (*(cJSON *const *)a)->valuedouble;
+  double y = (*(cJSON *const *)b)->valuedouble;
+  return (x > y) - (x < y);
+}
+
+static bool fuzzItems(const cJSON *array) {
+  int count = 0;
+  cJSON *last = NULL;
+  for (cJSON *child = array->child; child != NULL; child = child->next) {
+    if (cJSON_GetArrayItem(array, count++) != child)
+      return false;
+    last = child;
+  }
+  return cJSON_GetArraySize(array) == count &&
+         cJSON_GetArrayItem(array, count) == NULL &&
+         cJSON_GetArrayItem(array, -1) == NULL &&
+         (last == NULL || array->child->prev == last);
+}
+
+static bool fuzzArrayIndex(Uint64 *random) /* Some never indexed before they
+                                              are sorted */
+{
+  cJSON *array = cJSON_CreateArray();
+  if (array == NULL)
+    return false;
+  for (int i = 0, count = fuzzRandom(random) % 48; i < count; i++)
+    cJSON_AddItemToArray(array, cJSON_CreateNumber(fuzzRandom(random) % 32));
+  bool success = fuzzRandom(random) % 4 == 0 || cJSON_IndexArray(array);
+
+  for (int step = 0; success && step < FUZZ_INDEX_STEPS; step++) {
+    int size = cJSON_GetArraySize(array);
+    cJSON *item = cJSON_CreateNumber(fuzzRandom(random) % 32);
+    switch (fuzzRandom(random) % 10) {
+    case 0:
+      cJSON_AddItemToArray(array, item);
+      item = NULL;
+      break;
+    case 1: /* At or past the end */
+      if (cJSON_InsertItemInArray(array, size + fuzzRandom(random) % 3, item))
+        item = NULL;
+      break;
+    case 2:
+      if (cJSON_InsertItemInArray(array, fuzzRandom(random) % (size + 1),
+                                  item))
+        item = NULL;
+      break;
+    case 3:
+      cJSON_Delete(cJSON_DetachItemFromArray(array, 0));
+      break;
+    case 4:
+      cJSON_Delete(cJSON_DetachItemFromArray(array, size - 1));
+      break;
+    case 5:
+      if (size > 0)
+        cJSON_DeleteItemFromArray(array, fuzzRandom(random) % size);
+      break;
+    case 6:
+      if (size > 0 &&
+          cJSON_ReplaceItemInArray(array, fuzzRandom(random) % size, item))
+        item = NULL;
+      break;
+    case 7:
+      if (size > 0 &&
+          cJSON_ReplaceItemViaPointer(
+              array, cJSON_GetArrayItem(array, fuzzRandom(random) % size),
+              item))
+        item = NULL;
+      break;
+    case 8:
+      success = cJSON_SortArray(array, fuzzOrder);
+      for (cJSON *child = array->child;
+           success && child != NULL && child->next != NULL;
+           child = child->next)
+        success = child->valuedouble <= child->next->valuedouble;
+      break;
+    default:
+      success = cJSON_IndexArray(array);
+    }
+    cJSON_Delete(item);
+    success = success && fuzzItems(array);
+  }
+  cJSON_Delete(array);
+  return success;
+}
+
+int main(int argc, char *args[]) {
+  Uint32 docs = FUZZ_DOCS;
+  Uint64 random = 0x9E3779B97F4A7C15ull;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(args[i], "--docs") == 0 && i + 1 < argc)
+      docs = strtoul(args[++i], NULL, 10);
+    else if (strcmp(args[i], "--seed") == 0 && i + 1 < argc)
+      random = strtoull(args[++i], NULL, 10) | 1;
+    else {
+      printf("Usage: %s [--docs <count>] [--seed <number>]\n", args[0]);
+      return 1;
+    }
+  }
+
+  int best = cJSON_SetSimdLevel(cJSON_SimdAVX2);
+  printf("Best SIMD level %i, %u documents.\n", best, docs);
+
+  FuzzText text = {};
+  Uint32 parsed = 0, mismatches = 0, numberMismatches = 0;
+  Uint32 indexMismatches = 0;
+  for (Uint32 doc = 0; doc < docs; doc++) {
+    fuzzDocument(&text, &random);
+    if (text.data == NULL)
+      break;
+    Uint64 chunkSeed = fuzzRandom(&random) | 1;
+
+    FuzzResult scalar;
+    cJSON_SetSimdLevel(cJSON_SimdNone);
+    fuzzRun(&text, chunkSeed, &scalar);
+    parsed += scalar.parsed;
+    if (!fuzzSame(scalar.compact, scalar.insitu) && mismatches++ < 8)
+      printf("In-place mismatch on document %u: %.*s\n", doc,
+             (int)SDL_min(text.length, 200), text.data);
+
+    for (int level = cJSON_SimdSSE2; level <= best; level++) {
+      FuzzResult vector;
+      cJSON_SetSimdLevel(level);
+      fuzzRun(&text, chunkSeed, &vector);
+      if (!fuzzCompare(&scalar, &vector)) {
+        if (mismatches++ < 8)
+          printf("Mismatch at level %i on document %u: %.*s\n", level, doc,
+                 (int)SDL_min(text.length, 200), text.data);
+      }
+      fuzzFree(&vector);
+    }
+    fuzzFree(&scalar);
+
+    for (int i = 0; i < FUZZ_NUMBERS; i++)
+      numberMismatches += !fuzzNumber(&random);
+    indexMismatches += !fuzzObjectIndex(&random);
+    indexMismatches += !fuzzArrayIndex(&random);
+  }
+  cJSON_SetSimdLevel(best);
+
+  printf("%u documents, %u parsed, %u mismatches.\n", docs, parsed,
+         mismatches);
+  printf("%u numbers, %u mismatches.\n", docs * FUZZ_NUMBERS,
+         numberMismatches);
+  printf("%u indexed objects and arrays, %u mismatches.\n", docs * 2,
+         indexMismatches);
+  free(text.data);
+  bool success =
+      mismatches == 0 && numberMismatches == 0 && indexMismatches == 0;
+  return success ? 0 : 1;
+}
@@ -0,0 +1,601 @@
+#include "../deps/includes.h"
+#include "../deps/objects.h"
+
+/* Benchmark: how the scores pipeline scales with the number of entries.
+ * Generates leaderboards with Zipf distributed usernames, times each
+ * operation on the cJSON pipeline and on the binary leaderboard, and prints
+ * one CSV row per measurement
+ * Usage: scorebench [--sizes 1000,100000,...] [--json <file>]
+ *                   [--json-max <entries>] */
+
+#define BENCH_SIZES "1000,100000,1000000,10000000"
+#define BENCH_JSON_MAX 1000000 /* Larger cJSON trees take gigabytes */
+#define BENCH_MAX_SIZES 16
+#define BENCH_INSERTS 1000
+#define BENCH_PAGES 100
+#define BENCH_ZIPF 1.1
+#define BENCH_GAMES 8 /* Average games per player */
+#define BENCH_USER "player1"
+
+#define BENCH_JSON_FILE "bench_scores.json"
+#define BENCH_BIN_FILE "bench_scores.bin"
+#define BENCH_JOURNAL_FILE "bench_scores.journal"
+#define BENCH_INDEX_FILE "bench_scores.idx"
+
+typedef struct BenchResult {
+  const char *backend;
+  Uint32 entries;
+  const char *operation;
+  double ms;
+  Uint32 rows; /* What the operation returned or walked, or cJSON
+                 allocations for load_allocs */
+} BenchResult;
+
+typedef struct Bench {
+  BenchResult *results;
+  int resultCount;
+  int resultCapacity;
+
+  double *nameCdf; /* Zipf over the name pool */
+  Uint32 nameCount;
+  Uint64 random;
+
+  volatile Sint64 sink; /* Keeps walks from being optimized out */
+} Bench;
+
+static Uint64 benchRandom(Bench *bench) /* xorshift64*, same data every run */
+{
+  bench->random ^= bench->random >> 12;
+  bench->random ^= bench->random << 25;
+  bench->random ^= bench->random >> 27;
+  return bench->random * 2685821657736338717ull;
+}
+
+static bool benchNames(Bench *bench, Uint32 entries) {
+  free(bench->nameCdf);
+  bench->nameCount = entries / BENCH_GAMES + 16;
+  bench->nameCdf = malloc(bench->nameCount * sizeof(double));
+  if (bench->nameCdf == NULL)
+    return false;
+
+  double total = 0;
+  for (Uint32 i = 0; i < bench->nameCount; i++) {
+    total += 1 / SDL_pow(i + 1, BENCH_ZIPF);
+    bench->nameCdf[i] = total;
+  }
+  for (Uint32 i = 0; i < bench->nameCount; i++)
+    bench->nameCdf[i] /= total;
+
+  return true;
+}
+
+static void benchRecord(Bench *bench, ScoreRecord *record) {
+  double pick = (benchRandom(bench) >> 11) * (1.0 / 9007199254740992.0);
+  Uint32 low = 0, high = bench->nameCount - 1;
+  while (low < high) {
+    Uint32 mid = low + (high - low) / 2;
+    if (bench->nameCdf[mid] < pick)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  memset(record, 0, sizeof(ScoreRecord));
+  snprintf(record->username, sizeof(record->username), "player%u", low);
+  /* Most games end early, a few go long */
+  record->score = benchRandom(bench) % (1 + benchRandom(bench) % 200);
+  record->time = record->score * 3 + benchRandom(bench) % 60;
+}
+
+static Uint64 benchStart(void) { return SDL_GetPerformanceCounter(); }
+
+static void benchAdd(Bench *bench, const char *backend, Uint32 entries,
+                     const char *operation, Uint64 start, Uint32 rows) {
+  double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 /
+              SDL_GetPerformanceFrequency();
+
+  if (bench->resultCount == bench->resultCapacity) {
+    int capacity = bench->resultCapacity ? bench->resultCapacity * 2 : 64;
+    BenchResult *grown =
+        realloc(bench->results, capacity * sizeof(BenchResult));
+    if (grown == NULL)
+      return;
+    bench->results = grown;
+    bench->resultCapacity = capacity;
+  }
+
+  BenchResult *result = &bench->results[bench->resultCount++];
+  result->backend = backend;
+  result->entries = entries;
+  result->operation = operation;
+  result->ms = ms;
+  result->rows = rows;
+
+  printf("%s,%u,%s,%.3f,%u\n", backend, entries, operation, ms, rows);
+  fflush(stdout);
+}
+
+static Uint32 benchAllocs; /* cJSON allocations while counting */
+
+static void *benchMalloc(size_t size) {
+  benchAllocs++;
+  return malloc(size);
+}
+
+static void benchCount(bool counting) /* Only around parses, cJSON drops
+                                         realloc with custom hooks */
+{
+  cJSON_Hooks hooks = {benchMalloc, free};
+  cJSON_InitHooks(counting ? &hooks : NULL);
+  benchAllocs = 0;
+}
+
+static bool benchStreamCount(void *data, const ScoreRecord *record) {
+  (*(Uint32 *)data)++;
+  return true;
+}
+
+static int compareBenchScores(const void *a, const void *b) {
+  const ScoreRecord *recordA = *(const ScoreRecord **)a;
+  const ScoreRecord *recordB = *(const ScoreRecord **)b;
+  return recordB->score - recordA->score;
+}
+
+static const char *sortNames[SORTCOUNT] = {"sort_score", "sort_time",
+                                           "sort_name"};
+
+static cJSON *benchScoreObj(const ScoreRecord *record) {
+  cJSON *scoreObj = cJSON_CreateObject();
+  cJSON_AddStringToObject(scoreObj, "Username", record->username);
+  cJSON_AddNumberToObject(scoreObj, "Score", record->score);
+  cJSON_AddNumberToObject(scoreObj, "Time", record->time);
+  return scoreObj;
+}
+
+/* Same access the old SCORES screen did, 8 rows by position */
+static void benchPages(Bench *bench, const char *backend, Uint32 entries,
+                       const char *name, cJSON *scores, Uint32 count) {
+  Uint64 start = benchStart();
+  for (int page = 0; page < BENCH_PAGES; page++) {
+    Uint32 rank = benchRandom(bench) % count;
+    for (Uint32 i = 0; i < 8 && rank + i < count; i++) {
+      cJSON *scoreObj = cJSON_GetArrayItem(scores, rank + i);
+      bench->sink += cJSON_GetObjectItem(scoreObj, "Score")->valueint;
+    }
+  }
+  benchAdd(bench, backend, entries, name, start, BENCH_PAGES * 8);
+}
+
+static void benchJsonArena(Bench *bench,
+                           Uint32 entries) /* Same file, one arena per tree */
+{
+  const char *backend = "json_arena";
+
+  Uint64 start = benchStart();
+  char *jsonData = extractScores(BENCH_JSON_FILE);
+  benchCount(true);
+  cJSON_Arena *arena = cJSON_ArenaCreate(0);
+  cJSON *root = jsonData != NULL ? cJSON_ArenaParse(arena, jsonData) : NULL;
+  Uint32 allocs = benchAllocs;
+  benchCount(false);
+  free(jsonData);
+  Uint32 count = cJSON_GetArraySize(cJSON_GetObjectItem(root, "Scores"));
+  benchAdd(bench, backend, entries, "load", start, count);
+  benchAdd(bench, backend, entries, "load_allocs", benchStart(), allocs);
+
+  start = benchStart();
+  bool saved = root != NULL && saveScores(root, BENCH_JSON_FILE);
+  benchAdd(bench, backend, entries, "save", start, saved ? count : 0);
+
+  start = benchStart();
+  cJSON_ArenaDelete(arena);
+  benchAdd(bench, backend, entries, "free", start, count);
+}
+
+static void benchJsonInsitu(Bench *bench,
+                            Uint32 entries) /* Same file, strings left in the
+                                               text */
+{
+  const char *backend = "json_insitu";
+
+  Uint64 start = benchStart();
+  char *jsonData = extractScores(BENCH_JSON_FILE);
+  benchCount(true);
+  cJSON *root = jsonData != NULL ? cJSON_ParseInsitu(jsonData) : NULL;
+  Uint32 allocs = benchAllocs;
+  benchCount(false);
+  Uint32 count = cJSON_GetArraySize(cJSON_GetObjectItem(root, "Scores"));
+  benchAdd(bench, backend, entries, "load", start, count);
+  benchAdd(bench, backend, entries, "load_allocs", benchStart(), allocs);
+
+  start = benchStart();
+  cJSON_Delete(root);
+  free(jsonData);
+  benchAdd(bench, backend, entries, "free", start, count);
+}
+
+static void benchJsonSimd(Bench *bench,
+                          Uint32 entries) /* Same file at each SIMD level */
+{
+  static const char *backends[] = {"json_scalar", "json_sse2", "json_avx2"};
+  char *jsonData = extractScores(BENCH_JSON_FILE);
+  if (jsonData == NULL)
+    return;
+
+  int best = cJSON_SetSimdLevel(cJSON_SimdAVX2);
+  for (int level = cJSON_SimdNone; level <= best; level++) {
+    cJSON_SetSimdLevel(level);
+    Uint64 start = benchStart();
+    cJSON *root = cJSON_Parse(jsonData);
+    Uint32 count = cJSON_GetArraySize(cJSON_GetObjectItem(root, "Scores"));
+    benchAdd(bench, backends[level], entries, "parse", start, count);
+
+    /* Formatted, so whitespace gets scanned too on the way back */
+    start = benchStart();
+    char *printed = root != NULL ? cJSON_Print(root) : NULL;
+    benchAdd(bench, backends[level], entries, "print", start,
+             printed != NULL ? count : 0);
+
+    start = benchStart();
+    cJSON *reparsed = printed != NULL ? cJSON_Parse(printed) : NULL;
+    benchAdd(bench, backends[level], entries, "parse_formatted", start,
+             reparsed != NULL ? count : 0);
+
+    cJSON_Delete(reparsed);
+    cJSON_free(printed);
+    cJSON_Delete(root);
+  }
+  cJSON_SetSimdLevel(best);
+  free(jsonData);
+}
+
+static void benchJsonNumbers(Bench *bench,
+                             Uint32 entries) /* Numbers only, as many as the
+                                                file has scores */
+{
+  const char *names[] = {"json_integers", "json_doubles"};
+
+  for (int doubles = 0; doubles < 2; doubles++) {
+    cJSON *numbers = cJSON_CreateArray();
+    for (Uint32 i = 0; i < entries; i++) {
+      double number = (double)(benchRandom(bench) % 100000);
+      if (doubles)
+        number /= 1000.0;
+      cJSON_AddItemToArray(numbers, cJSON_CreateNumber(number));
+    }
+
+    Uint64 start = benchStart();
+    char *jsonData = cJSON_PrintUnformatted(numbers);
+    benchAdd(bench, names[doubles], entries, "print", start,
+             jsonData != NULL ? entries : 0);
+    cJSON_Delete(numbers);
+
+    start = benchStart();
+    numbers = jsonData != NULL ? cJSON_Parse(jsonData) : NULL;
+    benchAdd(bench, names[doubles], entries, "parse", start,
+             cJSON_GetArraySize(numbers));
+    cJSON_Delete(numbers);
+    cJSON_free(jsonData);
+  }
+}
+
+static void benchJson(Bench *bench, Uint32 entries) /* scores.json path */
+{
+  const char *backend = "json";
+  ScoreRecord record;
+
+  /* Setup -> The file saveScores would have left */
+  cJSON *root = cJSON_CreateObject();
+  cJSON *scores = cJSON_AddArrayToObject(root, "Scores");
+  for (Uint32 i = 0; i < entries; i++) {
+    benchRecord(bench, &record);
+    cJSON_AddItemToArray(scores, benchScoreObj(&record));
+  }
+  bool saved = saveScores(root, BENCH_JSON_FILE);
+  cJSON_Delete(root);
+  if (!saved) {
+    printf("Unable to write '%s'.\n", BENCH_JSON_FILE);
+    return;
+  }
+
+  Uint64 start = benchStart();
+  char *jsonData = extractScores(BENCH_JSON_FILE);
+  benchCount(true);
+  root = jsonData != NULL ? cJSON_Parse(jsonData) : NULL;
+  Uint32 allocs = benchAllocs;
+  benchCount(false);
+  free(jsonData);
+  scores = cJSON_GetObjectItem(root, "Scores");
+  benchAdd(bench, backend, entries, "load", start, cJSON_GetArraySize(scores));
+  benchAdd(bench, backend, entries, "load_allocs", benchStart(), allocs);
+
+  /* Same file token by token, nothing kept */
+  Uint32 streamed = 0;
+  start = benchStart();
+  FILE *file = fopen(BENCH_JSON_FILE, "rb");
+  if (file != NULL) {
+    streamScores(file, BENCH_JSON_FILE, benchStreamCount, &streamed, NULL);
+    fclose(file);
+  }
+  benchAdd(bench, backend, entries, "stream", start, streamed);
+  if (scores == NULL) {
+    cJSON_Delete(root);
+    remove(BENCH_JSON_FILE);
+    return;
+  }
+
+  start = benchStart();
+  for (int i = 0; i < BENCH_INSERTS; i++) {
+    benchRecord(bench, &record);
+    cJSON_AddItemToArray(scores, benchScoreObj(&record));
+  }
+  benchAdd(bench, backend, entries, "insert", start, BENCH_INSERTS);
+  Uint32 count = cJSON_GetArraySize(scores);
+  benchPages(bench, backend, entries, "page_list", scores, count);
+
+  for (int type = 0; type < SORTCOUNT; type++) {
+    start = benchStart();
+    sortScores(root, type);
+    benchAdd(bench, backend, entries, sortNames[type], start, count);
+  }
+
+  cJSON *scoreObj = NULL;
+  Uint32 matches = 0;
+  start = benchStart();
+  cJSON_ArrayForEach(scoreObj, scores) {
+    if (strcmp(cJSON_GetObjectItem(scoreObj, "Username")->valuestring,
+               BENCH_USER) == 0)
+      matches++;
+  }
+  benchAdd(bench, backend, entries, "filter", start, matches);
+
+  matches = 0;
+  start = benchStart();
+  cJSON_ArrayForEach(scoreObj, scores) {
+    if (strncmp(cJSON_GetObjectItem(scoreObj, "Username")->valuestring,
+                BENCH_USER, strlen(BENCH_USER)) == 0)
+      matches++;
+  }
+  benchAdd(bench, backend, entries, "prefix", start, matches);
+
+  /* sortScores left the array indexed */
+  benchPages(bench, backend, entries, "page", scores, count);
+
+  start = benchStart();
+  saved = saveScores(root, BENCH_JSON_FILE);
+  benchAdd(bench, backend, entries, "save", start, saved ? count : 0);
+
+  /* How saveScores wrote before streaming, the whole text then the file */
+  start = benchStart();
+  jsonData = cJSON_PrintUnformatted(root);
+  FILE *output = jsonData != NULL ? fopen(BENCH_JSON_FILE, "w") : NULL;
+  saved = output != NULL && fputs(jsonData, output) >= 0;
+  if (output != NULL)
+    fclose(output);
+  cJSON_free(jsonData);
+  benchAdd(bench, backend, entries, "save_string", start, saved ? count : 0);
+
+  start = benchStart();
+  cJSON_Delete(root);
+  benchAdd(bench, backend, entries, "free", start, count);
+
+  benchJsonArena(bench, entries);
+  benchJsonInsitu(bench, entries);
+  benchJsonSimd(bench, entries);
+  benchJsonNumbers(bench, entries);
+  remove(BENCH_JSON_FILE);
+}
+
+static void benchFilesRemove(void) {
+  remove(BENCH_BIN_FILE);
+  remove(BENCH_JOURNAL_FILE);
+  remove(BENCH_INDEX_FILE);
+}
+
+static void benchLeaderboard(Bench *bench,
+                             Uint32 entries) /* Snapshot, journal and index */
+{
+  const char *backend = "leaderboard";
+  Leaderboard leaderboard;
+  ScoreRecord record;
+
+  /* Setup -> A compacted snapshot with no saved index yet */
+  benchFilesRemove();
+  ScoreRecord *records = malloc((entries ? entries : 1) * sizeof(ScoreRecord));
+  if (records == NULL) {
+    printf("Not enough memory for %u entries.\n", entries);
+    return;
+  }
+  for (Uint32 i = 0; i < entries; i++)
+    benchRecord(bench, &records[i]);
+  bool created = leaderboardCreate(BENCH_BIN_FILE, records, entries);
+  free(records);
+  if (!created)
+    return;
+
+  /* First open sorts and saves the index, later ones read it */
+  Uint64 start = benchStart();
+  bool opened = leaderboardOpen(&leaderboard, BENCH_BIN_FILE,
+                                BENCH_JOURNAL_FILE, BENCH_INDEX_FILE, NULL);
+  benchAdd(bench, backend, entries, "load", start, leaderboard.count);
+  if (!opened) {
+    benchFilesRemove();
+    return;
+  }
+  leaderboardClose(&leaderboard);
+
+  start = benchStart();
+  opened = leaderboardOpen(&leaderboard, BENCH_BIN_FILE, BENCH_JOURNAL_FILE,
+                           BENCH_INDEX_FILE, NULL);
+  benchAdd(bench, backend, entries, "reload", start, leaderboard.count);
+  if (!opened) {
+    benchFilesRemove();
+    return;
+  }
+
+  start = benchStart();
+  for (int i = 0; i < BENCH_INSERTS; i++) {
+    benchRecord(bench, &record);
+    leaderboardAppend(&leaderboard, &record);
+  }
+  leaderboardCommit(&leaderboard);
+  benchAdd(bench, backend, entries, "insert", start, BENCH_INSERTS);
+  Uint32 count = leaderboard.count;
+
+  /* Orders are kept sorted, so a sort is a walk of one */
+  for (int type = 0; type < SORTCOUNT; type++) {
+    start = benchStart();
+    for (Uint32 rank = 0; rank < count; rank++)
+      bench->sink +=
+          leaderboardRecord(&leaderboard, leaderboardAt(&leaderboard, type,
+                                                        rank))
+              ->score;
+    benchAdd(bench, backend, entries, sortNames[type], start, count);
+  }
+
+  /* Top K -> What the first page needs, resident against a full sort */
+  const ScoreRecord *top[TOPK_SIZE];
+  Uint32 topIds[TOPK_SIZE];
+  start = benchStart();
+  for (int page = 0; page < BENCH_PAGES; page++) {
+    int topCount = leaderboardTop(&leaderboard, page % 2 ? TIME : SCORE, top,
+                                  topIds, TOPK_SIZE);
+    for (int i = 0; i < topCount; i++)
+      bench->sink += top[i]->score;
+  }
+  benchAdd(bench, backend, entries, "top", start, BENCH_PAGES * TOPK_SIZE);
+
+  const ScoreRecord **sorted = malloc((count ? count : 1) * sizeof(void *));
+  if (sorted != NULL) {
+    start = benchStart();
+    for (Uint32 id = 0; id < count; id++)
+      sorted[id] = leaderboardRecord(&leaderboard, id);
+    qsort(sorted, count, sizeof(ScoreRecord *), compareBenchScores);
+    for (Uint32 i = 0; i < TOPK_SIZE && i < count; i++)
+      bench->sink += sorted[i]->score;
+    benchAdd(bench, backend, entries, "top_sort", start, count);
+    free(sorted);
+  }
+
+  start = benchStart();
+  const NameEntry *user = leaderboardFind(&leaderboard, BENCH_USER);
+  Uint32 matches = user != NULL ? user->count : 0;
+  for (Uint32 i = 0; i < matches; i++)
+    bench->sink +=
+        leaderboardRecord(&leaderboard, user->ids[SCORE][i])->score;
+  benchAdd(bench, backend, entries, "filter", start, matches);
+
+  LeaderboardQuery query = {};
+  Uint32 ids[8];
+  start = benchStart();
+  leaderboardQuery(&leaderboard, &query, BENCH_USER);
+  leaderboardQueryPage(&leaderboard, &query, SCORE, 0, ids, 8);
+  benchAdd(bench, backend, entries, "prefix", start, query.matchCount);
+
+  /* Same matches at random cursors, as End and rank jumps move it */
+  start = benchStart();
+  for (int page = 0; page < BENCH_PAGES && query.matchCount > 0; page++)
+    bench->sink += leaderboardQueryPage(
+        &leaderboard, &query, SCORE, benchRandom(bench) % query.matchCount,
+        ids, 8);
+  benchAdd(bench, backend, entries, "prefix_pages", start, BENCH_PAGES * 8);
+  leaderboardQueryFree(&query);
+
+  start = benchStart();
+  for (int page = 0; page < BENCH_PAGES; page++) {
+    Uint32 rank = benchRandom(bench) % count;
+    for (Uint32 i = 0; i < 8 && rank + i < count; i++)
+      bench->sink += leaderboardRecord(&leaderboard,
+                                       leaderboardAt(&leaderboard, SCORE,
+                                                     rank + i))
+                         ->score;
+  }
+  benchAdd(bench, backend, entries, "page", start, BENCH_PAGES * 8);
+
+  /* Inserts are already in the journal, closing drains what's queued */
+  start = benchStart();
+  leaderboardClose(&leaderboard);
+  benchAdd(bench, backend, entries, "save", start, count);
+
+  benchFilesRemove();
+}
+
+static bool benchSave(Bench *bench, const char *fileName) {
+  cJSON *root = cJSON_CreateArray();
+  for (int i = 0; i < bench->resultCount; i++) {
+    BenchResult *result = &bench->results[i];
+    cJSON *row = cJSON_CreateObject();
+    cJSON_AddStringToObject(row, "Backend", result->backend);
+    cJSON_AddNumberToObject(row, "Entries", result->entries);
+    cJSON_AddStringToObject(row, "Operation", result->operation);
+    cJSON_AddNumberToObject(row, "Ms", result->ms);
+    cJSON_AddNumberToObject(row, "Rows", result->rows);
+    cJSON_AddItemToArray(root, row);
+  }
+
+  FILE *file = fopen(fileName, "w");
+  bool success = file != NULL && cJSON_PrintToFile(root, true, file);
+  if (file != NULL && fclose(file) != 0)
+    success = false;
+  cJSON_Delete(root);
+
+  return success;
+}
+
+int main(int argc, char *args[]) {
+  const char *sizeList = BENCH_SIZES;
+  const char *jsonFile = NULL;
+  Uint32 jsonMax = BENCH_JSON_MAX;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(args[i], "--sizes") == 0 && i + 1 < argc)
+      sizeList = args[++i];
+    else if (strcmp(args[i], "--json") == 0 && i + 1 < argc)
+      jsonFile = args[++i];
+    else if (strcmp(args[i], "--json-max") == 0 && i + 1 < argc)
+      jsonMax = strtoul(args[++i], NULL, 10);
+    else {
+      printf("Usage: %s [--sizes 1000,100000,...] [--json <file>] "
+             "[--json-max <entries>]\n",
+             args[0]);
+      return 1;
+    }
+  }
+
+  Uint32 sizes[BENCH_MAX_SIZES];
+  int sizeCount = 0;
+  for (const char *size = sizeList; *size != '\0' && sizeCount < BENCH_MAX_SIZES;
+       size++) {
+    char *end;
+    sizes[sizeCount++] = strtoul(size, &end, 10);
+    size = end;
+    if (*size == '\0')
+      break;
+  }
+
+  Bench bench = {};
+  printf("backend,entries,operation,ms,rows\n");
+  for (int i = 0; i < sizeCount; i++) {
+    if (sizes[i] == 0)
+      continue;
+    if (!benchNames(&bench, sizes[i])) {
+      printf("Not enough memory for %u entries.\n", sizes[i]);
+      break;
+    }
+
+    /* Same seed per size so both backends see the same records */
+    bench.random = 0x9E3779B97F4A7C15ull;
+    if (sizes[i] <= jsonMax)
+      benchJson(&bench, sizes[i]);
+    bench.random = 0x9E3779B97F4A7C15ull;
+    benchLeaderboard(&bench, sizes[i]);
+  }
+
+  bool success = jsonFile == NULL || benchSave(&bench, jsonFile);
+  if (!success)
+    printf("Unable to write '%s'.\n", jsonFile);
+
+  free(bench.results);
+  free(bench.nameCdf);
+  return success ? 0 : 1;
+}
@@ -0,0 +1,568 @@
+#include "../deps/includes.h"
+#include "../deps/objects.h"
+
+/* Bulk import and export between scores.json files and the leaderboard
+ * files in bounded memory. JSON is streamed a chunk at a time, records go
+ * straight into a new snapshot through an external merge sort and the
+ * index can be sorted the same way, so inputs can be far larger than
+ * memory. Reports throughput in MB/s
+ * Usage: scoreport import [--memory <MB>] [--index] <scores.bin>
+ *                         <scores.json|scores.bin>...
+ *        scoreport export <scores.bin> <scores.json> */
+
+#define PORT_MEMORY_MB 64 /* Per sort, held before a run is spilled */
+#define PORT_CHUNK (64 * 1024) /* Read or written at a time */
+#define PORT_MAX_RUNS 64 /* Merged at once, more take another pass */
+
+/* External Merge Sort */
+
+typedef int (*PortCompare)(const void *a, const void *b);
+typedef bool (*PortEmit)(void *data, const void *item);
+
+/* Items are sorted in memory until the budget fills, then spilled to a run
+ * file. Finishing merges the runs, PORT_MAX_RUNS at a time */
+typedef struct PortSorter {
+  size_t size; /* Bytes per item */
+  PortCompare compare; /* Must be total, runs don't keep input order */
+  char *items;
+  size_t count;
+  size_t capacity;
+
+  FILE *runs[PORT_MAX_RUNS];
+  int runIds[PORT_MAX_RUNS];
+  int runCount;
+  int nextRunId;
+  char prefix[300]; /* Runs are prefix.runN */
+} PortSorter;
+
+static bool sorterInit(PortSorter *sorter, size_t size, PortCompare compare,
+                       size_t memory, const char *prefix) {
+  memset(sorter, 0, sizeof(PortSorter));
+  sorter->size = size;
+  sorter->compare = compare;
+  sorter->capacity = SDL_max(memory / size, 1);
+  snprintf(sorter->prefix, sizeof(sorter->prefix), "%s", prefix);
+
+  sorter->items = malloc(sorter->capacity * size);
+  return sorter->items != NULL;
+}
+
+static void sorterRunName(PortSorter *sorter, int id, char *name,
+                          size_t length) {
+  snprintf(name, length, "%s.run%d", sorter->prefix, id);
+}
+
+static FILE *sorterRunOpen(PortSorter *sorter) /* New, empty run */
+{
+  char name[320];
+  sorterRunName(sorter, sorter->nextRunId, name, sizeof(name));
+  FILE *run = fopen(name, "w+b");
+  if (run == NULL) {
+    printf("Unable to open '%s'.\n", name);
+    return NULL;
+  }
+  setvbuf(run, NULL, _IOFBF, PORT_CHUNK);
+
+  sorter->runIds[sorter->runCount] = sorter->nextRunId++;
+  sorter->runs[sorter->runCount++] = run;
+  return run;
+}
+
+static void sorterRunsClose(PortSorter *sorter, int first, int count) {
+  for (int i = first; i < first + count; i++) {
+    char name[320];
+    sorterRunName(sorter, sorter->runIds[i], name, sizeof(name));
+    fclose(sorter->runs[i]);
+    remove(name);
+  }
+
+  sorter->runCount -= count;
+  memmove(&sorter->runs[first], &sorter->runs[first + count],
+          (sorter->runCount - first) * sizeof(FILE *));
+  memmove(&sorter->runIds[first], &sorter->runIds[first + count],
+          (sorter->runCount - first) * sizeof(int));
+}
+
+static bool sorterHeapLess(PortSorter *sorter, char *heads, int a, int b) {
+  int order =
+      sorter->compare(heads + a * sorter->size, heads + b * sorter->size);
+  return order < 0 || (order == 0 && a < b);
+}
+
+static void sorterHeapDown(PortSorter *sorter, char *heads, int *heap,
+                           int count, int at) {
+  while (true) {
+    int child = 2 * at + 1;
+    if (child >= count)
+      return;
+    if (child + 1 < count &&
+        sorterHeapLess(sorter, heads, heap[child + 1], heap[child]))
+      child++;
+    if (!sorterHeapLess(sorter, heads, heap[child], heap[at]))
+      return;
+
+    int swap = heap[at];
+    heap[at] = heap[child];
+    heap[child] = swap;
+    at = child;
+  }
+}
+
+static bool sorterMerge(PortSorter *sorter, int count, PortEmit emit,
+                        void *data) /* The first count runs, in order */
+{
+  char *heads = malloc(count * sorter->size);
+  int heap[PORT_MAX_RUNS];
+  int heapCount = 0;
+  if (heads == NULL)
+    return false;
+
+  for (int i = 0; i < count; i++) {
+    rewind(sorter->runs[i]);
+    if (fread(heads + i * sorter->size, sorter->size, 1, sorter->runs[i]) == 1)
+      heap[heapCount++] = i;
+  }
+  for (int i = heapCount / 2 - 1; i >= 0; i--)
+    sorterHeapDown(sorter, heads, heap, heapCount, i);
+
+  bool success = true;
+  while (success && heapCount > 0) {
+    int run = heap[0];
+    char *head = heads + run * sorter->size;
+    success = emit(data, head);
+
+    if (fread(head, sorter->size, 1, sorter->runs[run]) != 1)
+      heap[0] = heap[--heapCount];
+    sorterHeapDown(sorter, heads, heap, heapCount, 0);
+  }
+  free(heads);
+
+  return success;
+}
+
+typedef struct PortRunWriter {
+  FILE *run;
+  size_t size;
+} PortRunWriter;
+
+static bool runWriterEmit(void *data, const void *item) {
+  PortRunWriter *writer = data;
+  return fwrite(item, writer->size, 1, writer->run) == 1;
+}
+
+static bool sorterSpill(PortSorter *sorter) /* Items into a sorted run */
+{
+  qsort(sorter->items, sorter->count, sorter->size, sorter->compare);
+
+  FILE *run = sorterRunOpen(sorter);
+  if (run == NULL ||
+      fwrite(sorter->items, sorter->size, sorter->count, run) != sorter->count)
+    return false;
+  sorter->count = 0;
+
+  /* Nearly too many to merge at once -> Fold them into one longer run */
+  if (sorter->runCount == PORT_MAX_RUNS - 1) {
+    PortRunWriter writer = {NULL, sorter->size};
+    writer.run = sorterRunOpen(sorter);
+    if (writer.run == NULL ||
+        !sorterMerge(sorter, PORT_MAX_RUNS - 1, runWriterEmit, &writer))
+      return false;
+    sorterRunsClose(sorter, 0, PORT_MAX_RUNS - 1);
+  }
+
+  return true;
+}
+
+static bool sorterAdd(PortSorter *sorter, const void *item) {
+  if (sorter->count == sorter->capacity && !sorterSpill(sorter))
+    return false;
+
+  memcpy(sorter->items + sorter->count * sorter->size, item, sorter->size);
+  sorter->count++;
+  return true;
+}
+
+static bool sorterFinish(PortSorter *sorter, PortEmit emit,
+                         void *data) /* Every item in order, then frees */
+{
+  bool success = true;
+
+  /* Never spilled -> Sorted in memory, no files at all */
+  if (sorter->runCount == 0) {
+    qsort(sorter->items, sorter->count, sorter->size, sorter->compare);
+    for (size_t i = 0; success && i < sorter->count; i++)
+      success = emit(data, sorter->items + i * sorter->size);
+  } else {
+    success = (sorter->count == 0 || sorterSpill(sorter));
+    free(sorter->items);
+    sorter->items = NULL;
+    success = success && sorterMerge(sorter, sorter->runCount, emit, data);
+  }
+
+  free(sorter->items);
+  sorter->items = NULL;
+  sorterRunsClose(sorter, 0, sorter->runCount);
+  return success;
+}
+
+/* Sort Keys -> The same orders and ties the leaderboard keeps */
+
+typedef struct PortEntry {
+  ScoreRecord record;
+  Uint64 seq; /* Input position, ties keep it like leaderboardCreate */
+} PortEntry;
+
+typedef struct TimeKey {
+  Sint32 time;
+  Uint32 id;
+} TimeKey;
+
+typedef struct NameKey {
+  char username[USERNAME_MAX];
+  Uint32 id;
+} NameKey;
+
+static int compareEntries(const void *a, const void *b) {
+  const PortEntry *entryA = a;
+  const PortEntry *entryB = b;
+
+  int order = (entryB->record.score > entryA->record.score) -
+              (entryB->record.score < entryA->record.score);
+  if (order != 0)
+    return order;
+  return (entryA->seq > entryB->seq) - (entryA->seq < entryB->seq);
+}
+
+static int compareTimeKeys(const void *a, const void *b) {
+  const TimeKey *keyA = a;
+  const TimeKey *keyB = b;
+
+  int order = (keyB->time > keyA->time) - (keyB->time < keyA->time);
+  if (order != 0)
+    return order;
+  return (keyA->id > keyB->id) - (keyA->id < keyB->id);
+}
+
+static int compareNameKeys(const void *a, const void *b) {
+  const NameKey *keyA = a;
+  const NameKey *keyB = b;
+
+  int order = strncmp(keyA->username, keyB->username, USERNAME_MAX);
+  if (order != 0)
+    return order;
+  return (keyA->id > keyB->id) - (keyA->id < keyB->id);
+}
+
+/* Import */
+
+typedef struct PortImport {
+  PortSorter records;
+  PortSorter times;
+  PortSorter names;
+  bool index;
+  Uint64 seq;
+  Uint64 bytes; /* Input read */
+
+  FILE *snapshot;
+  Uint32 count;
+} PortImport;
+
+static bool importAdd(void *data, const ScoreRecord *record) {
+  PortImport *import = data;
+  PortEntry entry;
+  entry.record = *record;
+  entry.seq = import->seq++;
+  return sorterAdd(&import->records, &entry);
+}
+
+static bool importSnapshot(PortImport *import, FILE *file,
+                           const char *fileName) /* Records of another
+                                                    leaderboard, its journal
+                                                    isn't read */
+{
+  LeaderboardHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      header.magic != LEADERBOARD_MAGIC ||
+      header.version != LEADERBOARD_VERSION ||
+      header.recordSize != sizeof(ScoreRecord)) {
+    printf("'%s' is not a leaderboard file.\n", fileName);
+    return false;
+  }
+  import->bytes += sizeof(header);
+
+  ScoreRecord record;
+  for (Uint32 i = 0; i < header.count; i++) {
+    if (fread(&record, sizeof(record), 1, file) != 1) {
+      printf("'%s' is truncated.\n", fileName);
+      return false;
+    }
+    if (!importAdd(import, &record))
+      return false;
+  }
+  import->bytes += (Uint64)header.count * sizeof(ScoreRecord);
+
+  return true;
+}
+
+static bool importRecordEmit(void *data, const void *item) /* Next ID */
+{
+  PortImport *import = data;
+  const PortEntry *entry = item;
+  if (import->count == SDL_MAX_UINT32) {
+    printf("More than %u scores.\n", SDL_MAX_UINT32);
+    return false;
+  }
+  if (fwrite(&entry->record, sizeof(ScoreRecord), 1, import->snapshot) != 1)
+    return false;
+
+  if (import->index) {
+    TimeKey time = {entry->record.time, import->count};
+    NameKey name;
+    memcpy(name.username, entry->record.username, USERNAME_MAX);
+    name.id = import->count;
+    if (!sorterAdd(&import->times, &time) || !sorterAdd(&import->names, &name))
+      return false;
+  }
+
+  import->count++;
+  return true;
+}
+
+static bool timeKeyEmit(void *data, const void *item) {
+  return fwrite(&((const TimeKey *)item)->id, sizeof(Uint32), 1, data) == 1;
+}
+
+static bool nameKeyEmit(void *data, const void *item) {
+  return fwrite(&((const NameKey *)item)->id, sizeof(Uint32), 1, data) == 1;
+}
+
+static void storeNames(const char *fileName, char *journalName,
+                       char *indexName) /* scores.bin -> scores.journal and
+                                           scores.idx, like the game's */
+{
+  const char *dot = strrchr(fileName, '.');
+  const char *slash = strrchr(fileName, '/');
+  int length = dot != NULL && (slash == NULL || dot > slash)
+                   ? (int)(dot - fileName)
+                   : (int)strlen(fileName);
+  snprintf(journalName, 300, "%.*s.journal", length, fileName);
+  snprintf(indexName, 300, "%.*s.idx", length, fileName);
+}
+
+static bool importIndex(PortImport *import, const char *indexName) {
+  char tempName[320];
+  snprintf(tempName, sizeof(tempName), "%s.tmp", indexName);
+  FILE *index = fopen(tempName, "wb");
+  if (index == NULL) {
+    printf("Unable to open '%s'.\n", tempName);
+    return false;
+  }
+  setvbuf(index, NULL, _IOFBF, PORT_CHUNK);
+
+  /* No player stats, the game computes them the first time it needs them */
+  IndexHeader header = {INDEX_MAGIC, INDEX_VERSION, import->count, 0, 0, 0};
+  bool success = fwrite(&header, sizeof(header), 1, index) == 1 &&
+                 sorterFinish(&import->times, timeKeyEmit, index) &&
+                 sorterFinish(&import->names, nameKeyEmit, index);
+  success = fclose(index) == 0 && success;
+
+  if (success && SDL_RenamePath(tempName, indexName))
+    return true;
+  remove(tempName);
+  return false;
+}
+
+static int portImport(const char *fileName, char **inputs, int inputCount,
+                      size_t memory, bool index) {
+  char journalName[300], indexName[300], tempName[320], namesName[320];
+  storeNames(fileName, journalName, indexName);
+  snprintf(tempName, sizeof(tempName), "%s.tmp", fileName);
+  snprintf(namesName, sizeof(namesName), "%s.names", indexName);
+
+  PortImport import = {};
+  import.index = index;
+  if (!sorterInit(&import.records, sizeof(PortEntry), compareEntries, memory,
+                  fileName) ||
+      (index && (!sorterInit(&import.times, sizeof(TimeKey), compareTimeKeys,
+                             memory, indexName) ||
+                 !sorterInit(&import.names, sizeof(NameKey), compareNameKeys,
+                             memory, namesName)))) {
+    printf("Not enough memory for the sort buffers.\n");
+    return 1;
+  }
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  bool success = true;
+  for (int i = 0; success && i < inputCount; i++) {
+    FILE *input = fopen(inputs[i], "rb");
+    if (input == NULL) {
+      printf("Unable to open '%s'.\n", inputs[i]);
+      success = false;
+      break;
+    }
+
+    Uint32 magic = 0;
+    bool binary = fread(&magic, sizeof(magic), 1, input) == 1 &&
+                  magic == LEADERBOARD_MAGIC;
+    rewind(input);
+    Uint64 before = import.seq;
+    success = binary ? importSnapshot(&import, input, inputs[i])
+                     : streamScores(input, inputs[i], importAdd, &import,
+                                    &import.bytes);
+    fclose(input);
+    if (success)
+      printf("Read %llu scores from '%s'.\n",
+             (unsigned long long)(import.seq - before), inputs[i]);
+  }
+
+  /* Records come out of the merge in score order, the snapshot's order */
+  import.snapshot = success ? fopen(tempName, "wb") : NULL;
+  if (import.snapshot != NULL) {
+    setvbuf(import.snapshot, NULL, _IOFBF, PORT_CHUNK);
+    LeaderboardHeader header = {LEADERBOARD_MAGIC, LEADERBOARD_VERSION,
+                                sizeof(ScoreRecord), 0, 0, 0};
+    success = fwrite(&header, sizeof(header), 1, import.snapshot) == 1 &&
+              sorterFinish(&import.records, importRecordEmit, &import);
+
+    header.count = import.count;
+    success = success && fseek(import.snapshot, 0, SEEK_SET) == 0 &&
+              fwrite(&header, sizeof(header), 1, import.snapshot) == 1;
+    success = fclose(import.snapshot) == 0 && success;
+    success = success && SDL_RenamePath(tempName, fileName);
+    if (!success) {
+      printf("Unable to write '%s'.\n", fileName);
+      remove(tempName);
+    }
+  } else if (success) {
+    printf("Unable to open '%s'.\n", tempName);
+    success = false;
+  }
+
+  /* An index left from the old records would be wrong, rebuilt if absent */
+  if (success && index && !importIndex(&import, indexName)) {
+    printf("Unable to write '%s', the game will rebuild it.\n", indexName);
+    remove(indexName);
+  } else if (success && !index) {
+    remove(indexName);
+  }
+
+  free(import.records.items);
+  free(import.times.items);
+  free(import.names.items);
+  sorterRunsClose(&import.records, 0, import.records.runCount);
+  sorterRunsClose(&import.times, 0, import.times.runCount);
+  sorterRunsClose(&import.names, 0, import.names.runCount);
+  if (!success)
+    return 1;
+
+  double seconds = (SDL_GetPerformanceCounter() - start) /
+                   (double)SDL_GetPerformanceFrequency();
+  double megabytes = import.bytes / (1024.0 * 1024.0);
+  printf("Imported %u scores, %.1f MB in %.2f s, %.1f MB/s.\n", import.count,
+         megabytes, seconds, megabytes / SDL_max(seconds, 1e-9));
+
+  SDL_PathInfo info;
+  if (SDL_GetPathInfo(journalName, &info) && info.size > 0)
+    printf("'%s' is not empty, its scores will be added on top.\n",
+           journalName);
+  return 0;
+}
+
+/* Export */
+
+static void exportString(FILE *output, const char *string) /* JSON escaped */
+{
+  fputc('"', output);
+  for (int i = 0; i < USERNAME_MAX && string[i] != '\0'; i++) {
+    unsigned char c = string[i];
+    if (c == '"' || c == '\\')
+      fprintf(output, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(output, "\\u%04x", c);
+    else
+      fputc(c, output);
+  }
+  fputc('"', output);
+}
+
+static int portExport(const char *fileName, const char *outputName) {
+  char journalName[300], indexName[300];
+  storeNames(fileName, journalName, indexName);
+  if (!SDL_GetPathInfo(fileName, NULL)) {
+    printf("Unable to open '%s'.\n", fileName);
+    return 1;
+  }
+
+  /* Mapped, so memory stays at the pages being written out */
+  Uint64 start = SDL_GetPerformanceCounter();
+  Leaderboard leaderboard;
+  if (!leaderboardOpen(&leaderboard, fileName, journalName, indexName, NULL))
+    return 1;
+
+  FILE *output = fopen(outputName, "wb");
+  if (output == NULL) {
+    printf("Unable to open '%s'.\n", outputName);
+    leaderboardClose(&leaderboard);
+    return 1;
+  }
+  setvbuf(output, NULL, _IOFBF, PORT_CHUNK);
+
+  /* Same layout saveScores writes, best first */
+  fputs("{\"Scores\":[", output);
+  for (Uint32 rank = 0; rank < leaderboard.count; rank++) {
+    const ScoreRecord *record = leaderboardRecord(
+        &leaderboard, leaderboardAt(&leaderboard, SCORE, rank));
+    fputs(rank > 0 ? ",{\"Username\":" : "{\"Username\":", output);
+    exportString(output, record->username);
+    fprintf(output, ",\"Score\":%d,\"Time\":%d}", record->score,
+            record->time);
+  }
+  fputs("]}", output);
+
+  long bytes = ftell(output);
+  bool success = !ferror(output);
+  success = fclose(output) == 0 && success;
+  Uint32 count = leaderboard.count;
+  leaderboardClose(&leaderboard);
+  if (!success) {
+    printf("Unable to write '%s'.\n", outputName);
+    return 1;
+  }
+
+  double seconds = (SDL_GetPerformanceCounter() - start) /
+                   (double)SDL_GetPerformanceFrequency();
+  double megabytes = bytes / (1024.0 * 1024.0);
+  printf("Exported %u scores, %.1f MB in %.2f s, %.1f MB/s.\n", count,
+         megabytes, seconds, megabytes / SDL_max(seconds, 1e-9));
+  return 0;
+}
+
+int main(int argc, char *args[]) {
+  size_t memory = (size_t)PORT_MEMORY_MB * 1024 * 1024;
+  bool index = false;
+  int first = 2;
+
+  if (argc >= 4 && strcmp(args[1], "export") == 0)
+    return portExport(args[2], args[3]);
+
+  for (; argc >= 2 && strcmp(args[1], "import") == 0 && first < argc;
+       first++) {
+    if (strcmp(args[first], "--memory") == 0 && first + 1 < argc)
+      memory = strtoull(args[++first], NULL, 10) * 1024 * 1024;
+    else if (strcmp(args[first], "--index") == 0)
+      index = true;
+    else
+      break;
+  }
+  if (argc < 2 || strcmp(args[1], "import") != 0 || first + 2 > argc ||
+      memory == 0) {
+    printf("Usage: %s import [--memory <MB>] [--index] <scores.bin> "
+           "<scores.json|scores.bin>...\n"
+           "       %s export <scores.bin> <scores.json>\n",
+           args[0], args[0]);
+    return 1;
+  }
+
+  return portImport(args[first], &args[first + 1], argc - first - 1, memory,
+                    index);
+}
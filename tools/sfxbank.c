@@ -0,0 +1,39 @@
+#include "../deps/includes.h"
+#include "../deps/objects.h"
+
+/* Build step: decodes the sound effects once into the mixer's output format
+ * Usage: sfxbank <bank file> <sound files...> */
+int main(int argc, char *args[]) {
+  if (argc < 3) {
+    printf("Usage: %s <bank file> <sound files...>\n", args[0]);
+    return 1;
+  }
+
+  /* No real device needed, only the mixer's conversion */
+  SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+  if (!SDL_Init(SDL_INIT_AUDIO)) {
+    printf("SDL could not be initialized! SDL Error: %s\n", SDL_GetError());
+    return 1;
+  }
+
+  SDL_AudioSpec audioSpec;
+  SDL_zero(audioSpec);
+  audioSpec.format = MIX_DEFAULT_FORMAT;
+  audioSpec.channels = SOUND_CHANNELS;
+  audioSpec.freq = SOUND_FREQ;
+  if (!Mix_OpenAudio(0, &audioSpec) || Mix_Init(MIX_INIT_OGG) == 0) {
+    printf("SDL_mixer could not be initialized! SDL_mixer Error: %s\n",
+           SDL_GetError());
+    SDL_Quit();
+    return 1;
+  }
+
+  bool success = soundBankBuild(args[1], &args[2], argc - 2);
+  if (success)
+    printf("'%s' written with %i sound effects\n", args[1], argc - 2);
+
+  Mix_CloseAudio();
+  Mix_Quit();
+  SDL_Quit();
+  return success ? 0 : 1;
+}